@@ -31,6 +31,7 @@
 #include <Nirvana/NDBC.h>
 #include "SemVer.h"
 #include "version.h"
+#include "factory.h"
 
 class Connection
 {
@@ -149,6 +150,34 @@ public:
 		}
 	}
 
+	/// Resolve all imports of the module in one query.
+	/// 
+	/// \param id Module id.
+	/// \param platform Target platform ID.
+	/// \param [in, out] bindings Resolved bindings are appended here.
+	void get_import_bindings (Nirvana::ModuleId id, Nirvana::PlatformId platform,
+		Nirvana::PM::CachedBindings& bindings)
+	{
+		auto stm = get_statement ("SELECT import.name,import.version,module.id,path,platform,module.flags"
+			" FROM import JOIN export ON export.name=import.name AND export.major=import.version>>16"
+			" AND export.minor>=(import.version&65535)"
+			" JOIN module ON module.id=export.module JOIN binary ON binary.module=module.id"
+			" WHERE import.module=? AND platform=?");
+		stm->setInt (1, id);
+		stm->setInt (2, platform);
+		NDBC::ResultSet::_ref_type rs = stm->executeQuery ();
+		while (rs->next ()) {
+			uint32_t ver = rs->getInt (2);
+			Nirvana::PM::Binding binding;
+			binding.module_id (rs->getInt (3));
+			binding.binary_path (rs->getString (4));
+			binding.platform (rs->getInt (5));
+			binding.module_flags (rs->getSmallInt (6));
+			bindings.emplace_back (rs->getString (1), major (ver), minor (ver), platform,
+				std::move (binding));
+		}
+	}
+
 	IDL::String get_module_name (Nirvana::ModuleId id)
 	{
 		auto stm = get_statement ("SELECT name,version,prerelease FROM module WHERE id=?");
@@ -28,15 +28,21 @@
 #pragma once
 
 #include <CORBA/Server.h>
+#include <Nirvana/Hash.h>
 #include "PacMan.h"
 #include "factory_s.h"
+#include "../Source/MapUnorderedUnstable.h"
 
 class Manager :
 	public CORBA::servant_traits <Nirvana::PM::Manager>::Servant <Manager>
 {
 public:
+	/// Cache size limit. The cache is cleared when exceeded.
+	static const size_t MAX_CACHED_BINDINGS = 4096;
+
 	Manager () noexcept :
-		in_progress_ (false)
+		in_progress_ (false),
+		generation_ (0)
 	{}
 
 	~Manager ()
@@ -48,6 +54,40 @@ public:
 		in_progress_ = false;
 	}
 
+	bool find_binding (const IDL::String& name, Nirvana::PlatformId platform,
+		Nirvana::PM::Binding& binding, uint32_t& generation) const
+	{
+		generation = generation_;
+		const char* name_begin = name.data ();
+		const char* sver = CORBA::Internal::RepId::version (name_begin, name_begin + name.size ());
+		CORBA::Internal::RepId::Version version (sver);
+		auto it = cache_.find (Key (IDL::String (name_begin, sver - name_begin), version.major,
+			version.minor, platform));
+		if (it == cache_.end ())
+			return false;
+		binding = it->second;
+		return true;
+	}
+
+	void cache_bindings (const Nirvana::PM::CachedBindings& bindings, uint32_t generation)
+	{
+		if (generation != generation_)
+			return;
+		if (cache_.size () + bindings.size () > MAX_CACHED_BINDINGS)
+			cache_.clear ();
+		for (const auto& b : bindings) {
+			cache_.emplace (Key (IDL::String (b.name ()), b.major (), b.minor (), b.platform ()),
+				b.binding ());
+		}
+	}
+
+	/// Called on commit of the package database changes.
+	void invalidate_bindings () noexcept
+	{
+		++generation_;
+		cache_.clear ();
+	}
+
 	Nirvana::PM::PacMan::_ref_type allocate ()
 	{
 		Nirvana::PM::PacMan::_ref_type obj;
@@ -61,7 +101,41 @@ public:
 	}
 
 private:
+	struct Key
+	{
+		IDL::String name;
+		uint16_t major;
+		uint16_t minor;
+		Nirvana::PlatformId platform;
+
+		Key (IDL::String&& n, uint16_t maj, uint16_t min, Nirvana::PlatformId pl) noexcept :
+			name (std::move (n)),
+			major (maj),
+			minor (min),
+			platform (pl)
+		{}
+
+		bool operator == (const Key& rhs) const noexcept
+		{
+			return name == rhs.name && major == rhs.major && minor == rhs.minor
+				&& platform == rhs.platform;
+		}
+	};
+
+	struct KeyHash
+	{
+		size_t operator () (const Key& key) const noexcept
+		{
+			size_t h = Nirvana::Hash::hash_bytes (key.name.data (), key.name.size ());
+			uint32_t v = ((uint32_t)key.major << 16) | key.minor;
+			h = Nirvana::Hash::append_bytes (h, &v, sizeof (v));
+			return Nirvana::Hash::append_bytes (h, &key.platform, sizeof (key.platform));
+		}
+	};
+
 	bool in_progress_;
+	uint32_t generation_;
+	Nirvana::Core::MapUnorderedUnstable <Key, Nirvana::PM::Binding, KeyHash> cache_;
 };
 
 #endif
@@ -52,6 +52,14 @@ long PacMan::compare_name (const Nirvana::PM::ObjBinding& l, const Nirvana::PM::
 	return version (r.major (), r.minor ()) - version (l.major (), l.minor ());
 }
 
+void PacMan::commit ()
+{
+	Lock lock (*this);
+	Connection::commit ();
+	manager_->invalidate_bindings ();
+	complete ();
+}
+
 void PacMan::complete () noexcept
 {
 	manager_->on_complete ();
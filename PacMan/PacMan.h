@@ -50,12 +50,7 @@ public:
 
 	~PacMan ();
 
-	void commit ()
-	{
-		Lock lock (*this);
-		Connection::commit ();
-		complete ();
-	}
+	void commit ();
 
 	void rollback ()
 	{
@@ -82,6 +82,34 @@ Packages::Packages (CORBA::Object::_ptr_type component) :
 	manager_ = Nirvana::PM::man_factory->create ();
 }
 
+void Packages::get_binding (const IDL::String& name, Nirvana::PlatformId platform,
+	Nirvana::PM::Binding& binding) const
+{
+	uint32_t generation;
+	if (manager_->find_binding (name, platform, binding, generation))
+		return;
+
+	Connection connection (pool_);
+	connection.get_binding (name, platform, binding);
+
+	Nirvana::PM::CachedBindings bindings;
+	const char* name_begin = name.data ();
+	const char* sver = CORBA::Internal::RepId::version (name_begin, name_begin + name.size ());
+	CORBA::Internal::RepId::Version version (sver);
+	bindings.emplace_back (IDL::String (name_begin, sver - name_begin), version.major, version.minor,
+		platform, binding);
+
+	// The module imports will be requested on the module loading.
+	// Resolve them all in one query.
+	try {
+		connection.get_import_bindings (binding.module_id (), platform, bindings);
+	} catch (...) {
+		// Just don't cache them
+	}
+
+	manager_->cache_bindings (bindings, generation);
+}
+
 inline void Packages::create_database ()
 {
 	Connection connection (Connection::connect_rwc);
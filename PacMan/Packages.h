@@ -47,10 +47,7 @@ public:
 	{}
 
 	void get_binding (const IDL::String& name, Nirvana::PlatformId platform,
-		Nirvana::PM::Binding& binding) const
-	{
-		Connection (pool_).get_binding (name, platform, binding);
-	}
+		Nirvana::PM::Binding& binding) const;
 
 	IDL::String get_module_name (Nirvana::ModuleId id) const
 	{
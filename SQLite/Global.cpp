@@ -40,7 +40,9 @@ inline
 Global::Global () :
 	file_system_ (Nirvana::FileSystem::_narrow (CosNaming::NamingContext::_narrow (
 		CORBA::the_orb->resolve_initial_references ("NameService"))->resolve (CosNaming::Name (1)))),
-	cs_key_ (-1)
+	cs_key_ (-1),
+	cs_shm_key_ (-1),
+	cs_page_cache_key_ (-1)
 {
 	sqlite3_config (SQLITE_CONFIG_PAGECACHE, nullptr, 0, 0);
 	sqlite3_config (SQLITE_CONFIG_MALLOC, &mem_methods);
@@ -51,12 +53,16 @@ Global::Global () :
 	sqlite3_initialize ();
 
 	cs_key_ = Nirvana::the_module->CS_alloc (wsd_deleter);
+	cs_shm_key_ = Nirvana::the_module->CS_alloc (shm_deleter);
+	cs_page_cache_key_ = Nirvana::the_module->CS_alloc (page_cache_deleter);
 }
 
 inline
 Global::~Global ()
 {
 	sqlite3_shutdown ();
+	Nirvana::the_module->CS_free (cs_page_cache_key_);
+	Nirvana::the_module->CS_free (cs_shm_key_);
 	Nirvana::the_module->CS_free (cs_key_);
 }
 
@@ -155,6 +161,36 @@ WritableStaticData& Global::static_data ()
 	}
 }
 
+void Global::shm_deleter (void* p)
+{
+	delete reinterpret_cast <SharedMemoryMap*> (p);
+}
+
+SharedMemoryMap& Global::shared_memory ()
+{
+	void* p = Nirvana::the_module->CS_get (cs_shm_key_);
+	if (!p) {
+		p = new SharedMemoryMap;
+		Nirvana::the_module->CS_set (cs_shm_key_, p);
+	}
+	return *reinterpret_cast <SharedMemoryMap*> (p);
+}
+
+void Global::page_cache_deleter (void* p)
+{
+	delete reinterpret_cast <PageCacheMap*> (p);
+}
+
+PageCacheMap& Global::page_caches ()
+{
+	void* p = Nirvana::the_module->CS_get (cs_page_cache_key_);
+	if (!p) {
+		p = new PageCacheMap;
+		Nirvana::the_module->CS_set (cs_page_cache_key_, p);
+	}
+	return *reinterpret_cast <PageCacheMap*> (p);
+}
+
 }
 
 extern "C" int sqlite3_wsd_init (int N, int J)
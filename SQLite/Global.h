@@ -32,6 +32,9 @@
 
 namespace SQLite {
 
+class SharedMemoryMap;
+class PageCacheMap;
+
 /// Module global data
 /// 
 class Global
@@ -50,13 +53,23 @@ public:
 
 	WritableStaticData& static_data ();
 
+	/// \returns Context-specific map of the WAL index shared memory.
+	SharedMemoryMap& shared_memory ();
+
+	/// \returns Context-specific map of the shared page caches.
+	PageCacheMap& page_caches ();
+
 private:
 	static void wsd_deleter (void*);
+	static void shm_deleter (void*);
+	static void page_cache_deleter (void*);
 
 private:
 	Nirvana::FileSystem::_ref_type file_system_;
 	WritableStaticData initial_static_data_;
 	int cs_key_;
+	int cs_shm_key_;
+	int cs_page_cache_key_;
 };
 
 extern Global global;
@@ -32,6 +32,9 @@
 #include <Nirvana/c_heap_dbg.h>
 #include <Nirvana/posix_defs.h>
 #include <Nirvana/RandomGen.h>
+#include <atomic>
+#include <limits>
+#include <memory>
 
 extern "C" int sqlite3_os_init ()
 {
@@ -52,16 +55,25 @@ extern const sqlite3_io_methods io_methods;
 class File : public sqlite3_file
 {
 public:
-	File (Nirvana::AccessDirect::_ref_type fa, int flags) noexcept :
+	File (Nirvana::AccessDirect::_ref_type fa, const char* path, int flags) noexcept :
 		access_ (std::move (fa)),
+		path_ (path),
 		lock_level_ (Nirvana::LockType::LOCK_NONE),
-		flags_ (flags)
+		flags_ (flags),
+		page_cache_ (nullptr),
+		shm_ (nullptr),
+		shm_shared_ (0),
+		shm_excl_ (0)
 	{
 		pMethods = &io_methods;
 	}
 
 	int close () noexcept
 	{
+		if (shm_)
+			shm_unmap (false);
+		if (page_cache_)
+			page_cache_close ();
 		try {
 			Nirvana::File::_ref_type file_to_delete;
 			if (flags_ & SQLITE_OPEN_DELETEONCLOSE)
@@ -77,9 +89,18 @@ public:
 
 	int read (void* p, int cb, sqlite3_int64 off) const noexcept
 	{
+		if (page_cache_ && lock_level_ >= Nirvana::LockType::LOCK_SHARED) {
+			PageCache::Page* page = page_cache_->find (off, cb);
+			if (page) {
+				memcpy (p, page->data.data (), cb);
+				page_cache_->release (page);
+				return SQLITE_OK;
+			}
+		}
+
 		int ret = SQLITE_OK;
 		try {
-			NDBC::Blob data;
+			NDBC::Blob& data = io_buffer_;
 			access_->read (off, cb, data);
 			memcpy (p, data.data (), data.size ());
 			if ((int)data.size () < cb) {
@@ -93,6 +114,7 @@ public:
 		} catch (...) {
 			ret = SQLITE_IOERR_READ;
 		}
+		release_io_buffer ();
 		return ret;
 	}
 
@@ -100,7 +122,9 @@ public:
 	{
 		int ret = SQLITE_OK;
 		try {
-			access_->write (off, NDBC::Blob ((const CORBA::Octet*)p, (const CORBA::Octet*)p + cb), false);
+			NDBC::Blob& data = io_buffer_;
+			data.assign ((const CORBA::Octet*)p, (const CORBA::Octet*)p + cb);
+			access_->write (off, data, false);
 		} catch (const CORBA::SystemException& ex) {
 			if (ENOSPC == Nirvana::get_minor_errno (ex.minor ()))
 				ret = SQLITE_FULL;
@@ -109,6 +133,9 @@ public:
 		} catch (...) {
 			ret = SQLITE_IOERR_WRITE;
 		}
+		release_io_buffer ();
+		if (page_cache_)
+			page_cache_->write (off, p, cb);
 		return ret;
 	}
 
@@ -120,6 +147,8 @@ public:
 		} catch (...) {
 			ret = SQLITE_IOERR_TRUNCATE;
 		}
+		if (page_cache_)
+			page_cache_->invalidate (size, std::numeric_limits <sqlite3_int64>::max ());
 		return ret;
 	}
 
@@ -157,38 +186,46 @@ public:
 
 	int fetch (sqlite3_int64 off, int cb, void** pp) noexcept
 	{
-		int ret = SQLITE_OK;
 		*pp = nullptr;
 		assert (cb);
-		auto it = cache_.find (off);
-		if (it == cache_.end ()) {
-			try {
-				CacheEntry entry;
-				access_->read (off, cb, entry.block);
-				if ((int)entry.block.size () == cb)
-					*pp = cache_.emplace (off, std::move (entry)).first->second.block.data ();
-			} catch (const CORBA::NO_MEMORY&) {
-				ret = SQLITE_IOERR_NOMEM;
-			} catch (...) {
-				ret = SQLITE_IOERR_READ;
-			}
-		} else {
-			if (cb > it->second.block.size ()) {
-				assert (false);
-				ret = SQLITE_IOERR_READ;
+		if (!page_cache_) {
+			// If the file has no page cache, *pp stays null and SQLite falls back to xRead.
+			int ret = page_cache_open ();
+			if (SQLITE_OK != ret || !page_cache_)
+				return ret;
+		}
+
+		int ret = SQLITE_OK;
+		PageCache::Page* page = page_cache_->find (off, cb);
+		try {
+			if (!page) {
+				NDBC::Blob block;
+				access_->read (off, cb, block);
+				if ((int)block.size () < cb)
+					return SQLITE_OK;
+				page = page_cache_->insert (off, std::move (block));
 			}
-			it->second.ref_cnt++;
-			*pp = it->second.block.data ();
+			auto ins = fetched_.emplace (page->data.data (), Fetched::mapped_type (page, 0));
+			++(ins.first->second.second);
+			*pp = page->data.data ();
+		} catch (const CORBA::NO_MEMORY&) {
+			ret = SQLITE_IOERR_NOMEM;
+		} catch (...) {
+			ret = SQLITE_IOERR_READ;
 		}
+		if (SQLITE_OK != ret && page)
+			page_cache_->release (page);
 		return ret;
 	}
 
 	int unfetch (sqlite3_int64 off, void* p) noexcept
 	{
-		auto it = cache_.find (off);
-//		assert (it != cache_.end ());
-		if (it != cache_.end () && !--(it->second.ref_cnt))
-			cache_.erase (it);
+		auto it = fetched_.find (p);
+		if (it != fetched_.end ()) {
+			page_cache_->release (it->second.first);
+			if (!--(it->second.second))
+				fetched_.erase (it);
+		}
 		return SQLITE_OK;
 	}
 
@@ -213,6 +250,9 @@ public:
 				if (lock_level_ < level)
 					return SQLITE_BUSY;
 
+				if (page_cache_ && Nirvana::LockType::LOCK_SHARED == level)
+					check_version ();
+
 			} catch (...) {
 				if (level > Nirvana::LockType::LOCK_SHARED)
 					return SQLITE_IOERR_LOCK;
@@ -249,23 +289,149 @@ public:
 		return SQLITE_OK;
 	}
 
+	int shm_map (int region, int size, bool extend, void volatile** pp) noexcept
+	{
+		*pp = nullptr;
+		if (!shm_) {
+			int ret = shm_open ();
+			if (SQLITE_OK != ret)
+				return ret;
+		}
+		return shm_->map (region, size, extend, pp);
+	}
+
+	int shm_lock (int offset, int n, int flags) noexcept
+	{
+		if (!shm_)
+			return SQLITE_IOERR_SHMLOCK;
+		return shm_->lock (offset, n, flags, shm_shared_, shm_excl_);
+	}
+
+	void shm_unmap (bool remove) noexcept
+	{
+		if (!shm_)
+			return;
+
+		shm_->lock (0, SQLITE_SHM_NLOCK, SQLITE_SHM_UNLOCK, shm_shared_, shm_excl_);
+		SharedMemory* shm = shm_;
+		shm_ = nullptr;
+		if (shm->release ()) {
+			// Remove from the map before closing the file to avoid races on the suspension.
+			Nirvana::AccessDirect::_ref_type access = shm->detach_access ();
+			global.shared_memory ().erase (path_);
+			SharedMemory::close (std::move (access), remove);
+		}
+	}
+
 private:
-	Nirvana::AccessDirect::_ref_type access_;
-	Nirvana::LockType lock_level_;
-	int flags_;
+	// The page I/O buffer is kept between calls to avoid allocation on each page.
+	static const size_t MAX_IO_BUFFER = 64 * 1024;
+
+	void release_io_buffer () const noexcept
+	{
+		if (io_buffer_.capacity () > MAX_IO_BUFFER)
+			NDBC::Blob ().swap (io_buffer_);
+	}
+
+	int page_cache_open () noexcept
+	{
+		if (!path_)
+			return SQLITE_OK;
+
+		try {
+			PageCache& cache = global.page_caches ()
+				.emplace (std::piecewise_construct, std::forward_as_tuple (path_),
+					std::forward_as_tuple ()).first->second;
+			cache.add_ref ();
+			page_cache_ = &cache;
+		} catch (const CORBA::NO_MEMORY&) {
+			return SQLITE_IOERR_NOMEM;
+		} catch (...) {
+			return SQLITE_IOERR_READ;
+		}
+
+		// The cache may be filled by other connections while this one held no lock.
+		if (lock_level_ >= Nirvana::LockType::LOCK_SHARED)
+			check_version ();
+		return SQLITE_OK;
+	}
+
+	void page_cache_close () noexcept
+	{
+		for (const auto& entry : fetched_) {
+			for (unsigned cnt = entry.second.second; cnt; --cnt) {
+				page_cache_->release (entry.second.first);
+			}
+		}
+		fetched_.clear ();
+		if (page_cache_->release ())
+			global.page_caches ().erase (path_);
+		page_cache_ = nullptr;
+	}
+
+	void check_version () noexcept
+	{
+		NDBC::Blob version;
+		try {
+			access_->read (PageCache::VERSION_OFFSET, PageCache::VERSION_SIZE, version);
+		} catch (...) {
+			version.clear ();
+		}
+		page_cache_->check_version (version);
+	}
 
-	struct CacheEntry
+	int shm_open () noexcept
 	{
-		NDBC::Blob block;
-		unsigned ref_cnt;
+		if (!path_)
+			return SQLITE_IOERR_SHMOPEN;
 
-		CacheEntry () :
-			ref_cnt (1)
-		{}
-	};
+		try {
+			SharedMemoryMap& map = global.shared_memory ();
+			auto it = map.find (path_);
+			if (it == map.end ()) {
+				Nirvana::AccessDirect::_ref_type access;
+				int ret = SharedMemory::open (path_, access);
+				if (SQLITE_OK != ret)
+					return ret;
+
+				// Other connection could create the entry while we were suspended.
+				it = map.find (path_);
+				if (it == map.end ()) {
+					try {
+						it = map.emplace (std::piecewise_construct, std::forward_as_tuple (path_),
+							std::forward_as_tuple (std::move (access))).first;
+					} catch (...) {
+						SharedMemory::close (std::move (access), false);
+						throw;
+					}
+				} else
+					SharedMemory::close (std::move (access), false);
+			}
+			it->second.add_ref ();
+			shm_ = &it->second;
+		} catch (const CORBA::NO_MEMORY&) {
+			return SQLITE_IOERR_NOMEM;
+		} catch (...) {
+			return SQLITE_IOERR_SHMOPEN;
+		}
+		return SQLITE_OK;
+	}
 
-	typedef Nirvana::Core::MapUnorderedUnstable <sqlite3_int64, CacheEntry> Cache;
-	Cache cache_;
+private:
+	Nirvana::AccessDirect::_ref_type access_;
+	const char* path_;
+	Nirvana::LockType lock_level_;
+	int flags_;
+	PageCache* page_cache_;
+	SharedMemory* shm_;
+	unsigned shm_shared_;
+	unsigned shm_excl_;
+	mutable NDBC::Blob io_buffer_;
+
+	// Fetched page data -> page, fetch count
+	typedef Nirvana::Core::MapUnorderedUnstable <const void*, std::pair <PageCache::Page*, unsigned> >
+		Fetched;
+	Fetched fetched_;
 };
 
 extern "C" int xClose (sqlite3_file * f) noexcept
@@ -338,6 +504,28 @@ extern "C" int xUnfetch (sqlite3_file* f, sqlite3_int64 iOfst, void* p)
 	return static_cast <File&> (*f).unfetch (iOfst, p);
 }
 
+extern "C" int xShmMap (sqlite3_file* f, int iPg, int pgsz, int bExtend, void volatile** pp)
+{
+	return static_cast <File&> (*f).shm_map (iPg, pgsz, bExtend != 0, pp);
+}
+
+extern "C" int xShmLock (sqlite3_file* f, int offset, int n, int flags)
+{
+	assert (offset >= 0 && n >= 1 && offset + n <= SQLITE_SHM_NLOCK);
+	return static_cast <File&> (*f).shm_lock (offset, n, flags);
+}
+
+extern "C" void xShmBarrier (sqlite3_file*)
+{
+	std::atomic_thread_fence (std::memory_order_seq_cst);
+}
+
+extern "C" int xShmUnmap (sqlite3_file* f, int deleteFlag)
+{
+	static_cast <File&> (*f).shm_unmap (deleteFlag != 0);
+	return SQLITE_OK;
+}
+
 extern "C" int xFileControl (sqlite3_file * f, int op, void* pArg)
 {
 	return SQLITE_NOTFOUND;
@@ -357,14 +545,259 @@ const sqlite3_io_methods io_methods = {
 	xFileControl,
 	xSectorSize,
 	xDeviceCharacteristics,
-	nullptr, // xShmMap
-	nullptr, // xShmLock
-	nullptr, // xShmBarrier
-	nullptr, // xShmUnmap
+	xShmMap,
+	xShmLock,
+	xShmBarrier,
+	xShmUnmap,
 	xFetch,
 	xUnfetch
 };
 
+SharedMemory::~SharedMemory ()
+{
+	for (void* p : regions_) {
+		Nirvana::the_memory->release (p, region_size_);
+	}
+}
+
+int SharedMemory::open (const char* db_path, Nirvana::AccessDirect::_ref_type& access) noexcept
+{
+	try {
+		std::string path (db_path);
+		path += "-shm";
+		access = global.open_file (path.c_str (), SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+
+		// The WAL index memory is not visible for other contexts.
+		// Exclusive lock prevents the concurrent use of the WAL from them.
+		if (access->lock (Nirvana::FileLock (0, 1, Nirvana::LockType::LOCK_EXCLUSIVE),
+			Nirvana::LockType::LOCK_EXCLUSIVE, 0) < Nirvana::LockType::LOCK_EXCLUSIVE
+		) {
+			close (std::move (access), false);
+			return SQLITE_BUSY;
+		}
+	} catch (const CORBA::NO_MEMORY&) {
+		close (std::move (access), false);
+		return SQLITE_IOERR_NOMEM;
+	} catch (...) {
+		close (std::move (access), false);
+		return SQLITE_IOERR_SHMOPEN;
+	}
+	return SQLITE_OK;
+}
+
+void SharedMemory::close (Nirvana::AccessDirect::_ref_type access, bool remove) noexcept
+{
+	if (!access)
+		return;
+	try {
+		Nirvana::File::_ref_type file_to_delete;
+		if (remove)
+			file_to_delete = access->file ();
+		access->close ();
+		access = nullptr;
+		if (file_to_delete)
+			file_to_delete->remove ();
+	} catch (...) {
+	}
+}
+
+int SharedMemory::map (int region, int size, bool extend, void volatile** pp) noexcept
+{
+	if (region_size_ && region_size_ != size)
+		return SQLITE_IOERR_SHMSIZE;
+
+	if ((size_t)region >= regions_.size ()) {
+		if (!extend)
+			return SQLITE_OK;
+		region_size_ = size;
+		try {
+			regions_.reserve ((size_t)region + 1);
+			while (regions_.size () <= (size_t)region) {
+				regions_.push_back (Nirvana::the_memory->allocate (nullptr, size,
+					Nirvana::Memory::ZERO_INIT));
+			}
+		} catch (const CORBA::NO_MEMORY&) {
+			return SQLITE_NOMEM;
+		} catch (...) {
+			return SQLITE_IOERR_SHMMAP;
+		}
+	}
+	*pp = regions_ [region];
+	return SQLITE_OK;
+}
+
+int SharedMemory::lock (int offset, int n, int flags, unsigned& shared_mask, unsigned& excl_mask) noexcept
+{
+	unsigned mask = ((1U << n) - 1) << offset;
+	if (flags & SQLITE_SHM_UNLOCK) {
+		for (int i = offset; i < offset + n; ++i) {
+			unsigned bit = 1U << i;
+			if (excl_mask & bit)
+				locks_ [i] = 0;
+			else if (shared_mask & bit)
+				--locks_ [i];
+		}
+		shared_mask &= ~mask;
+		excl_mask &= ~mask;
+	} else if (flags & SQLITE_SHM_SHARED) {
+		if (!((shared_mask | excl_mask) & mask)) {
+			for (int i = offset; i < offset + n; ++i) {
+				if (locks_ [i] < 0)
+					return SQLITE_BUSY;
+			}
+			for (int i = offset; i < offset + n; ++i) {
+				++locks_ [i];
+			}
+			shared_mask |= mask;
+		}
+	} else {
+		for (int i = offset; i < offset + n; ++i) {
+			if (!(excl_mask & (1U << i)) && locks_ [i])
+				return SQLITE_BUSY;
+		}
+		for (int i = offset; i < offset + n; ++i) {
+			locks_ [i] = -1;
+		}
+		excl_mask |= mask;
+	}
+	return SQLITE_OK;
+}
+
+PageCache::~PageCache ()
+{
+	for (const auto& entry : pages_) {
+		assert (!entry.second->ref_cnt);
+		delete entry.second;
+	}
+}
+
+PageCache::Page* PageCache::find (sqlite3_int64 off, size_t size) noexcept
+{
+	auto it = pages_.find (off);
+	if (it == pages_.end ())
+		return nullptr;
+	Page* page = it->second;
+	if (page->data.size () < size)
+		return nullptr;
+	if (!page->ref_cnt++) {
+		unlink (page);
+		unused_bytes_ -= page->data.size ();
+	}
+	return page;
+}
+
+PageCache::Page* PageCache::insert (sqlite3_int64 off, NDBC::Blob&& data)
+{
+	std::unique_ptr <Page> page (new Page (off, std::move (data)));
+	auto ins = pages_.emplace (off, page.get ());
+	if (!ins.second) {
+		detach (ins.first->second);
+		ins.first->second = page.get ();
+	}
+	if (max_page_size_ < page->data.size ())
+		max_page_size_ = page->data.size ();
+	return page.release ();
+}
+
+void PageCache::release (Page* page) noexcept
+{
+	assert (page->ref_cnt);
+	if (!--(page->ref_cnt)) {
+		if (page->cached) {
+			push_front (page);
+			unused_bytes_ += page->data.size ();
+			shrink ();
+		} else
+			delete page;
+	}
+}
+
+void PageCache::write (sqlite3_int64 off, const void* p, size_t size) noexcept
+{
+	invalidate (off, off + (sqlite3_int64)size);
+
+	// Track own changes of the version to keep the cache valid after the local commits.
+	if (has_version_ && off <= VERSION_OFFSET
+		&& off + (sqlite3_int64)size >= VERSION_OFFSET + (sqlite3_int64)VERSION_SIZE)
+		memcpy (version_, (const CORBA::Octet*)p + (VERSION_OFFSET - off), VERSION_SIZE);
+}
+
+void PageCache::invalidate (sqlite3_int64 begin, sqlite3_int64 end) noexcept
+{
+	if (begin >= end || pages_.empty ())
+		return;
+
+	for (auto it = pages_.lower_bound (begin - (sqlite3_int64)max_page_size_ + 1);
+		it != pages_.end () && it->first < end;) {
+		Page* page = it->second;
+		if (page->offset + (sqlite3_int64)page->data.size () > begin) {
+			it = pages_.erase (it);
+			detach (page);
+		} else
+			++it;
+	}
+}
+
+void PageCache::check_version (const NDBC::Blob& version) noexcept
+{
+	if (has_version_ && version.size () == VERSION_SIZE
+		&& !memcmp (version_, version.data (), VERSION_SIZE))
+		return;
+
+	for (const auto& entry : pages_) {
+		detach (entry.second);
+	}
+	pages_.clear ();
+	max_page_size_ = 0;
+
+	has_version_ = version.size () == VERSION_SIZE;
+	if (has_version_)
+		memcpy (version_, version.data (), VERSION_SIZE);
+}
+
+void PageCache::detach (Page* page) noexcept
+{
+	page->cached = false;
+	if (!page->ref_cnt) {
+		unlink (page);
+		unused_bytes_ -= page->data.size ();
+		delete page;
+	}
+}
+
+void PageCache::unlink (Page* page) noexcept
+{
+	if (page->prev)
+		page->prev->next = page->next;
+	else
+		head_ = page->next;
+	if (page->next)
+		page->next->prev = page->prev;
+	else
+		tail_ = page->prev;
+	page->prev = page->next = nullptr;
+}
+
+void PageCache::push_front (Page* page) noexcept
+{
+	page->prev = nullptr;
+	page->next = head_;
+	if (head_)
+		head_->prev = page;
+	else
+		tail_ = page;
+	head_ = page;
+}
+
+void PageCache::shrink () noexcept
+{
+	while (unused_bytes_ > MAX_UNUSED_BYTES && tail_) {
+		Page* page = tail_;
+		pages_.erase (page->offset);
+		detach (page);
+	}
+}
+
 int xOpen (sqlite3_vfs*, sqlite3_filename zName, sqlite3_file* file,
 	int flags, int* pOutFlags) noexcept
 {
@@ -381,7 +814,7 @@ int xOpen (sqlite3_vfs*, sqlite3_filename zName, sqlite3_file* file,
 #endif
 		return SQLITE_CANTOPEN;
 	}
-	new (file) File (fa, flags);
+	new (file) File (fa, (flags & SQLITE_OPEN_MAIN_DB) ? zName : nullptr, flags);
 	return SQLITE_OK;
 }
 
@@ -28,7 +28,11 @@
 #pragma once
 
 #include <Nirvana/Nirvana.h>
+#include <Nirvana/File.h>
+#include <Nirvana/NDBC.h>
 #include "sqlite/sqlite3.h"
+#include "../Source/MapOrderedStable.h"
+#include <vector>
 
 #define VFS_NAME "nirvana"
 
@@ -44,6 +48,200 @@ namespace SQLite {
 
 extern struct sqlite3_vfs vfs;
 
+/// WAL index shared memory.
+/// 
+/// The WAL index is shared by all connections to the same database within the current
+/// sync context. The connections from other contexts are excluded by the exclusive lock
+/// on the "-shm" file.
+class SharedMemory
+{
+public:
+	SharedMemory (Nirvana::AccessDirect::_ref_type&& access) noexcept :
+		access_ (std::move (access)),
+		ref_cnt_ (0),
+		region_size_ (0),
+		locks_ { 0 }
+	{}
+
+	~SharedMemory ();
+
+	SharedMemory (const SharedMemory&) = delete;
+	SharedMemory& operator = (const SharedMemory&) = delete;
+
+	/// Open the "-shm" file and obtain the exclusive lock on it.
+	/// 
+	/// \param db_path Full database path.
+	/// \param [out] access The "-shm" file access.
+	/// \returns SQLite result code.
+	static int open (const char* db_path, Nirvana::AccessDirect::_ref_type& access) noexcept;
+
+	/// Close the "-shm" file and optionally delete it.
+	static void close (Nirvana::AccessDirect::_ref_type access, bool remove) noexcept;
+
+	void add_ref () noexcept
+	{
+		++ref_cnt_;
+	}
+
+	/// Release reference.
+	/// 
+	/// \returns `true` if it was the last reference.
+	bool release () noexcept
+	{
+		assert (ref_cnt_);
+		return !--ref_cnt_;
+	}
+
+	Nirvana::AccessDirect::_ref_type detach_access () noexcept
+	{
+		return std::move (access_);
+	}
+
+	/// Get the region, optionally allocating it.
+	int map (int region, int size, bool extend, void volatile** pp) noexcept;
+
+	/// Acquire or release slot locks.
+	/// 
+	/// \param offset First slot.
+	/// \param n Number of slots.
+	/// \param flags SQLite lock flags.
+	/// \param [in, out] shared_mask Shared locks held by the connection.
+	/// \param [in, out] excl_mask Exclusive locks held by the connection.
+	/// \returns SQLite result code.
+	int lock (int offset, int n, int flags, unsigned& shared_mask, unsigned& excl_mask) noexcept;
+
+private:
+	Nirvana::AccessDirect::_ref_type access_;
+	unsigned ref_cnt_;
+	int region_size_;
+	std::vector <void*> regions_;
+
+	// Lock counts: positive values are the shared lock counts, -1 is an exclusive lock.
+	int locks_ [SQLITE_SHM_NLOCK];
+};
+
+/// Database full path -> WAL index
+class SharedMemoryMap : public Nirvana::Core::MapOrderedStable <std::string, SharedMemory>
+{};
+
+/// Read-only page cache for xFetch.
+/// 
+/// The cache is shared by all connections to the same database within the current
+/// sync context. Pages are immutable: a write detaches the overlapped pages from the cache,
+/// the connections that still use them keep the old copy until xUnfetch.
+/// Writes from other contexts are detected by the file change counter in the database header.
+class PageCache
+{
+public:
+	/// Limit of the unused pages retained in the cache
+	static const size_t MAX_UNUSED_BYTES = 4 * 1024 * 1024;
+
+	/// File change counter and the following header fields
+	static const sqlite3_int64 VERSION_OFFSET = 24;
+	static const size_t VERSION_SIZE = 16;
+
+	struct Page
+	{
+		NDBC::Blob data;
+		sqlite3_int64 offset;
+		unsigned ref_cnt;
+		bool cached;
+
+		// LRU list of the unused pages
+		Page* prev;
+		Page* next;
+
+		Page (sqlite3_int64 off, NDBC::Blob&& block) noexcept :
+			data (std::move (block)),
+			offset (off),
+			ref_cnt (1),
+			cached (true),
+			prev (nullptr),
+			next (nullptr)
+		{}
+	};
+
+	PageCache () noexcept :
+		ref_cnt_ (0),
+		max_page_size_ (0),
+		unused_bytes_ (0),
+		head_ (nullptr),
+		tail_ (nullptr),
+		has_version_ (false),
+		version_ { 0 }
+	{}
+
+	~PageCache ();
+
+	PageCache (const PageCache&) = delete;
+	PageCache& operator = (const PageCache&) = delete;
+
+	void add_ref () noexcept
+	{
+		++ref_cnt_;
+	}
+
+	/// Release reference.
+	/// 
+	/// \returns `true` if it was the last reference.
+	bool release () noexcept
+	{
+		assert (ref_cnt_);
+		return !--ref_cnt_;
+	}
+
+	/// Find the page and add reference to it.
+	/// 
+	/// \param off Page offset.
+	/// \param size Minimal page size.
+	/// \returns The page or `nullptr`.
+	Page* find (sqlite3_int64 off, size_t size) noexcept;
+
+	/// Insert the page read from the file.
+	/// The existing page at the same offset is detached.
+	/// 
+	/// \returns The referenced page.
+	Page* insert (sqlite3_int64 off, NDBC::Blob&& data);
+
+	/// Release the page reference.
+	void release (Page* page) noexcept;
+
+	/// Detach pages overlapped with the written data.
+	/// The cached version is updated if the data contains it.
+	void write (sqlite3_int64 off, const void* p, size_t size) noexcept;
+
+	/// Detach pages overlapped with the range [begin, end).
+	void invalidate (sqlite3_int64 begin, sqlite3_int64 end) noexcept;
+
+	/// Detach all pages if the database version differs from the cached one.
+	/// 
+	/// \param version The header bytes at VERSION_OFFSET.
+	///   Empty or incomplete data invalidates the cache unconditionally.
+	void check_version (const NDBC::Blob& version) noexcept;
+
+private:
+	void detach (Page* page) noexcept;
+	void unlink (Page* page) noexcept;
+	void push_front (Page* page) noexcept;
+	void shrink () noexcept;
+
+private:
+	typedef Nirvana::Core::MapOrderedStable <sqlite3_int64, Page*> Pages;
+
+	Pages pages_;
+	unsigned ref_cnt_;
+	size_t max_page_size_;
+	size_t unused_bytes_;
+	Page* head_;
+	Page* tail_;
+	bool has_version_;
+	CORBA::Octet version_ [VERSION_SIZE];
+};
+
+/// Database full path -> page cache
+class PageCacheMap : public Nirvana::Core::MapOrderedStable <std::string, PageCache>
+{};
+
 }
 
 #endif
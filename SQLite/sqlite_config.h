@@ -46,9 +46,6 @@
 #define SQLITE_USE_URI 1
 #define SQLITE_WITHOUT_MSIZE 1
 
-// WAL requires shared memory. Impossible in Nirvana.
-#define SQLITE_OMIT_WAL 1
-
 #define HAVE_LOCALTIME_S 1
 #define HAVE_GMTIME_R 1
 
@@ -36,6 +36,8 @@
 #include "Singleton.h"
 #include "Executable.h"
 #include "SysDomain.h"
+#include "BackOff.h"
+#include "Runnable.h"
 
 using namespace CORBA;
 using namespace CORBA::Internal;
@@ -96,6 +98,7 @@ void Binder::initialize ()
 	SYNC_BEGIN (sync_domain (), nullptr);
 	singleton_->module_bind (nullptr, metadata, &context);
 	singleton_->object_map_ = std::move (context.exports);
+	singleton_->publish_snapshot ();
 	initialized_ = true;
 	SYNC_END ();
 }
@@ -105,6 +108,12 @@ void Binder::unload_modules ()
 {
 	housekeeping_timer_modules_.cancel ();
 
+	// Disable the lock-free lookups
+	snapshot_ptr_ = nullptr;
+	wait_readers (std::move (snapshot_));
+
+	discard_prefetched (true);
+
 	bool unloaded;
 	do {
 		// Unload unbound modules
@@ -389,12 +398,10 @@ Ref <Module> Binder::load (int32_t mod_id, AccessDirect::_ptr_type binary)
 			auto wait_list = entry.second.wait_list ();
 			try {
 
-				// Module loading may be a long operation, do it in core context.
-				SYNC_BEGIN (g_core_free_sync_context, &memory ());
-				mod = Module::create (mod_id, binary);
-				SYNC_END ();
+				mod = create_module (mod_id, binary);
 
 				assert (mod->_refcount_value () == 0);
+				prefetch_imports (*mod);
 				ModuleContext context (mod);
 				bind_and_init (*mod, context);
 				try {
@@ -403,6 +410,7 @@ Ref <Module> Binder::load (int32_t mod_id, AccessDirect::_ptr_type binary)
 					terminate_and_unbind (*mod);
 					throw;
 				}
+				publish_snapshot ();
 
 			} catch (...) {
 				module_map_.erase (entry.first);
@@ -430,6 +438,193 @@ Ref <Module> Binder::load (int32_t mod_id, AccessDirect::_ptr_type binary)
 	return mod;
 }
 
+class Binder::PrefetchImports : public Runnable
+{
+public:
+	PrefetchImports (ImportNames&& names) :
+		names_ (std::move (names))
+	{}
+
+private:
+	void run () override
+	{
+		singleton_->prefetch_modules (names_);
+	}
+
+private:
+	ImportNames names_;
+};
+
+class Binder::PrefetchModule : public Runnable
+{
+public:
+	PrefetchModule (int32_t mod_id, AccessDirect::_ref_type&& binary, Ref <PrefetchImpl>&& prefetch) :
+		mod_id_ (mod_id),
+		binary_ (std::move (binary)),
+		prefetch_ (std::move (prefetch))
+	{}
+
+private:
+	void run () override
+	{
+		Module* mod = nullptr;
+		std::exception_ptr ex;
+		try {
+			SYNC_BEGIN (g_core_free_sync_context, &memory ());
+			mod = Module::create (mod_id_, binary_);
+			SYNC_END ();
+		} catch (...) {
+			ex = std::current_exception ();
+		}
+		binary_ = nullptr;
+
+		SYNC_BEGIN (sync_domain (), nullptr);
+		singleton_->prefetch_complete (*prefetch_, mod, std::move (ex));
+		prefetch_ = nullptr;
+		SYNC_END ();
+	}
+
+private:
+	int32_t mod_id_;
+	AccessDirect::_ref_type binary_;
+	Ref <PrefetchImpl> prefetch_;
+};
+
+Module* Binder::create_module (int32_t mod_id, AccessDirect::_ptr_type binary)
+{
+	Module* mod = nullptr;
+	auto it = prefetch_map_.find (mod_id);
+	if (it != prefetch_map_.end ()) {
+		Ref <PrefetchImpl> prefetch = std::move (it->second);
+		prefetch_map_.erase (it);
+		if (!prefetch->event.signalled ())
+			prefetch->event.wait ();
+		if (prefetch->exception)
+			std::rethrow_exception (prefetch->exception);
+		mod = prefetch->mod;
+		prefetch->mod = nullptr;
+	} else {
+		// Module loading may be a long operation, do it in core context.
+		SYNC_BEGIN (g_core_free_sync_context, &memory ());
+		mod = Module::create (mod_id, binary);
+		SYNC_END ();
+	}
+	return mod;
+}
+
+void Binder::prefetch_imports (const Module& mod) noexcept
+{
+	try {
+		ImportNames names;
+		const Section& metadata = mod.metadata ();
+		for (OLF_Iterator <> it (metadata.address, metadata.size); !it.end (); it.next ()) {
+			if (!it.valid ())
+				return;
+			switch (*it.cur ()) {
+				case OLF_IMPORT_INTERFACE:
+				case OLF_IMPORT_OBJECT: {
+					const ImportInterface* ps = reinterpret_cast <const ImportInterface*> (it.cur ());
+					ObjectKey key (ps->name);
+					if (!object_map_.find (key))
+						names.emplace_back (key.name (), key.full_length ());
+				} break;
+			}
+		}
+
+		// Name resolution may require the remote calls, so it is done asynchronously.
+		if (!names.empty ())
+			ExecDomain::async_call <PrefetchImports> (ExecDomain::current ().deadline (),
+				sync_domain (), nullptr, std::move (names));
+	} catch (...) {
+		// Prefetch is an optimization only, the imports will be loaded on binding.
+	}
+}
+
+void Binder::prefetch_modules (const ImportNames& names) noexcept
+{
+	for (const auto& name : names) {
+		if (!initialized_)
+			break;
+		try {
+			CORBA::Internal::StringView <char> sname (name);
+			if (object_map_.find (ObjectKey (sname)))
+				continue;
+
+			Binding binding;
+			if (!SysDomain::get_sys_binding (sname, PLATFORM, binding))
+				SysDomainCore::_narrow (Services::bind (Services::SysDomain))->get_binding (sname, PLATFORM, binding);
+			if (!binding._d ())
+				continue;
+
+			// The maps may be changed while we were suspended.
+			ModuleLoad& ml = binding.module_load ();
+			int32_t mod_id = ml.module_id ();
+			if (!initialized_ || module_map_.find (mod_id) != module_map_.end ()
+				|| prefetch_map_.find (mod_id) != prefetch_map_.end ())
+				continue;
+
+			Ref <PrefetchImpl> prefetch = CORBA::make_reference <PrefetchImpl> ();
+			auto ins = prefetch_map_.emplace (mod_id, prefetch);
+			try {
+				ExecDomain::async_call <PrefetchModule> (ExecDomain::current ().deadline (),
+					g_core_free_sync_context, &BinderMemory::heap (), mod_id,
+					std::move (ml.binary ()), std::move (prefetch));
+			} catch (...) {
+				prefetch_map_.erase (ins.first);
+				throw;
+			}
+		} catch (...) {
+		}
+	}
+}
+
+void Binder::prefetch_complete (Prefetch& prefetch, Module* mod, std::exception_ptr ex) noexcept
+{
+	prefetch.mod = mod;
+	prefetch.exception = std::move (ex);
+	prefetch.event.signal ();
+
+	// Prefetch the import closure
+	if (mod && initialized_)
+		prefetch_imports (*mod);
+}
+
+void Binder::discard_prefetched (bool all) noexcept
+{
+	if (all) {
+		// Wait for completion. The map may be changed while we are suspended.
+		for (bool waited = true; waited;) {
+			waited = false;
+			for (const auto& entry : prefetch_map_) {
+				if (!entry.second->event.signalled ()) {
+					Ref <PrefetchImpl> prefetch = entry.second;
+					try {
+						prefetch->event.wait ();
+					} catch (...) {
+						assert (false);
+						return;
+					}
+					waited = true;
+					break;
+				}
+			}
+		}
+	}
+
+	for (auto it = prefetch_map_.begin (); it != prefetch_map_.end ();) {
+		Ref <PrefetchImpl> prefetch = it->second;
+		if (prefetch->event.signalled () && (all || prefetch->stale)) {
+			prefetch_map_.erase (it++);
+			Module* mod = prefetch->mod;
+			prefetch->mod = nullptr;
+			delete_module (mod);
+		} else {
+			prefetch->stale = prefetch->event.signalled ();
+			++it;
+		}
+	}
+}
+
 void Binder::bind_and_init (Module& mod, ModuleContext& context)
 {
 	const ModuleStartup* startup = module_bind (mod._get_ptr (), mod.metadata (), &context);
@@ -465,9 +660,11 @@ void Binder::bind_and_init (Module& mod, ModuleContext& context)
 	mod.on_load_complete ();
 }
 
-void Binder::unload (Module* mod) noexcept
+void Binder::unload (Module* mod, bool exports_hidden) noexcept
 {
 	remove_exports (mod->metadata ());
+	if (initialized_ && !exports_hidden)
+		wait_readers (publish_snapshot (mod));
 	terminate_and_unbind (*mod);
 	delete_module (mod);
 }
@@ -572,6 +769,84 @@ Binder::BindResult Binder::find (const ObjectKey& name)
 	return ret;
 }
 
+bool Binder::find_fast (const ObjectKey& name, String_in iid, BindResult& ret) noexcept
+{
+	if (!initialized_)
+		return false;
+
+	// The module binding context and the permission check require the synchronized path.
+	const ExecDomain& exec_domain = ExecDomain::current ();
+	if (exec_domain.TLS_get (CoreTLS::CORE_TLS_BINDER))
+		return false;
+	switch (exec_domain.sync_context ().sync_context_type ()) {
+	case SyncContext::Type::FREE_MODULE_TERM:
+	case SyncContext::Type::SINGLETON_TERM:
+		return false;
+	}
+
+	// While we hold the snapshot reference, the modules exporting its objects can not be unloaded.
+	Ref <Snapshot> snapshot (snapshot_ptr_.lock ());
+	snapshot_ptr_.unlock ();
+	if (!snapshot)
+		return false;
+
+	const ObjectVal* ov = snapshot->find (name);
+	if (!ov)
+		return false;
+
+	try {
+		ret.itf = query_interface (ov->itf, iid, name);
+		ret.sync_context = ov->sync_context;
+	} catch (...) {
+		// Let the synchronized path report the error
+		return false;
+	}
+	return true;
+}
+
+Ref <Binder::Snapshot> Binder::publish_snapshot (const Module* exclude) noexcept
+{
+	Ref <Snapshot> snapshot;
+	try {
+		snapshot = CORBA::make_reference <Snapshot> ();
+		snapshot->reserve (object_map_.size ());
+		for (const auto& el : object_map_) {
+			SyncContext* sc = el.second.sync_context;
+			if (sc && !(exclude && sc->module () == exclude))
+				snapshot->emplace (el.first, el.second);
+		}
+	} catch (...) {
+		// Disable the lock-free lookups until the next successful publication.
+		snapshot = nullptr;
+	}
+
+	snapshot_ptr_ = (Snapshot*)snapshot;
+	std::swap (snapshot, snapshot_);
+	return snapshot;
+}
+
+void Binder::wait_readers (Ref <Snapshot> old) noexcept
+{
+	// The reader holds the snapshot only for the lookup and the interface query.
+	if (old) {
+		for (BackOff bo; old->_refcount_value () > 1;) {
+			bo ();
+		}
+	}
+}
+
+bool Binder::hide_exports (Module& mod) noexcept
+{
+	wait_readers (publish_snapshot (&mod));
+
+	// The lock-free lookup could bind the module object before the new snapshot was published.
+	if (mod.bound ()) {
+		publish_snapshot ();
+		return false;
+	}
+	return true;
+}
+
 NIRVANA_NORETURN void Binder::throw_object_not_in_module (const ObjectKey& name, int32_t mod_id)
 {
 	BindError::Error ex;
@@ -584,6 +859,9 @@ NIRVANA_NORETURN void Binder::throw_object_not_in_module (const ObjectKey& name,
 Binder::BindResult Binder::bind_interface (CORBA::Internal::String_in name, CORBA::Internal::String_in iid)
 {
 	BindResult ret;
+	if (singleton_->find_fast (ObjectKey (name.data (), name.size ()), iid, ret))
+		return ret;
+
 	Ref <Request> rq = Request::create ();
 	rq->invoke ();
 	SYNC_BEGIN (sync_domain (), nullptr);
@@ -810,6 +1088,8 @@ uint_fast16_t Binder::get_module_bindings (AccessDirect::_ptr_type binary, PM::M
 inline
 void Binder::housekeeping_modules ()
 {
+	discard_prefetched (false);
+
 	for (;;) {
 		bool found = false;
 		SteadyTime t = Chrono::steady_clock ();
@@ -818,10 +1098,10 @@ void Binder::housekeeping_modules ()
 		t -= MODULE_UNLOAD_TIMEOUT;
 		for (auto it = module_map_.begin (); it != module_map_.end ();) {
 			Module* pmod = it->second.get_if_constructed ();
-			if (pmod && pmod->can_be_unloaded (t)) {
+			if (pmod && pmod->can_be_unloaded (t) && hide_exports (*pmod)) {
 				found = true;
 				it = module_map_.erase (it);
-				unload (pmod); // Causes context switch
+				unload (pmod, true); // Causes context switch
 				break;
 			} else
 				++it;
@@ -829,7 +1109,7 @@ void Binder::housekeeping_modules ()
 		if (!found)
 			break;
 	}
-	if (module_map_.empty ())
+	if (module_map_.empty () && prefetch_map_.empty ())
 		housekeeping_timer_modules_.cancel ();
 }
 
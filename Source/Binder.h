@@ -33,11 +33,14 @@
 #include "Synchronized.h"
 #include "Module.h"
 #include "BinderMemory.h"
+#include "BinderObject.h"
+#include "LockablePtr.h"
 #include <CORBA/RepId.h>
 #include <Nirvana/Main.h>
 #include <Nirvana/ModuleInit.h>
 #include "Nirvana/CoreDomains.h"
 #include "WaitableRef.h"
+#include "EventSync.h"
 #include "Chrono.h"
 #include "MapUnorderedStable.h"
 #include "MapUnorderedUnstable.h"
@@ -68,6 +71,7 @@ public:
 	using Allocator = BinderMemory::Allocator <T>;
 
 	Binder () :
+		snapshot_ptr_ (nullptr),
 		housekeeping_domains_on_ (false)
 	{}
 
@@ -364,6 +368,15 @@ private:
 		const ObjectVal* find (const ObjectKey& key) const;
 	};
 
+	// Immutable copy of the object map for the lock-free lookups.
+	// Contains the module exports only: the remote reference lifetime is not controlled by Binder.
+	class ObjectMapSnapshot :
+		public BinderObject,
+		public ObjectMap
+	{};
+
+	typedef ImplDynamic <ObjectMapSnapshot> Snapshot;
+
 	// Map of the loaded modules.
 	// Map must provide the pointer stability.
 	// phmap::node_hash_map is declared as with pointer stability,
@@ -397,6 +410,32 @@ private:
 
 	typedef SetUnorderedUnstable <PM::ObjBinding, BindingHash, BindingEq, Allocator> Dependencies;
 
+	// Module prefetch.
+	// Binaries of the modules imported by the loading module are loaded and relocated
+	// in parallel. Binding and initialization still go in the import order.
+	struct Prefetch : public UserObject
+	{
+		Module* mod;
+		std::exception_ptr exception;
+		EventSync event;
+		bool stale;
+
+		Prefetch () :
+			mod (nullptr),
+			stale (false)
+		{}
+	};
+
+	typedef ImplDynamicSync <Prefetch> PrefetchImpl;
+
+	typedef MapUnorderedUnstable <int32_t, Ref <PrefetchImpl>, std::hash <int32_t>,
+		std::equal_to <int32_t>, Allocator> PrefetchMap;
+
+	typedef std::vector <IDL::String, Allocator <IDL::String> > ImportNames;
+
+	class PrefetchImports;
+	class PrefetchModule;
+
 	// Module binding context
 	struct ModuleContext
 	{
@@ -452,6 +491,26 @@ private:
 	
 	BindResult find (const ObjectKey& name);
 
+	/// Lock-free lookup in the object map snapshot.
+	/// 
+	/// \returns `false` if the synchronized lookup is required.
+	bool find_fast (const ObjectKey& name, CORBA::Internal::String_in iid, BindResult& ret) noexcept;
+
+	/// Publish the object map snapshot.
+	/// Must be called from the Binder sync domain after each change of the object map.
+	/// 
+	/// \param exclude Module which exports must not be included.
+	/// \returns The previous snapshot.
+	Ref <Snapshot> publish_snapshot (const Module* exclude = nullptr) noexcept;
+
+	/// Wait until the lookups which use the old snapshot are completed.
+	static void wait_readers (Ref <Snapshot> old) noexcept;
+
+	/// Make the module exports invisible for the lock-free lookups before unloading.
+	/// 
+	/// \returns `false` if the module became bound in the meantime and can't be unloaded.
+	bool hide_exports (Module& mod) noexcept;
+
 	static InterfaceRef query_interface (InterfacePtr itf, CORBA::Internal::String_in iid, const ObjectKey& name);
 
 	static void query_interface (BindResult& ref, CORBA::Internal::String_in iid, const ObjectKey& name)
@@ -460,7 +519,28 @@ private:
 	}
 
 	Ref <Module> load (int32_t mod_id, AccessDirect::_ptr_type binary);
-	void unload (Module* pmod) noexcept;
+
+	/// Get the prefetched module or load it.
+	Module* create_module (int32_t mod_id, AccessDirect::_ptr_type binary);
+
+	/// Start prefetch of the modules imported by \p mod.
+	void prefetch_imports (const Module& mod) noexcept;
+
+	/// Resolve the import names and start the module prefetch.
+	/// Called from the Binder sync domain in a separate execution domain.
+	void prefetch_modules (const ImportNames& names) noexcept;
+
+	void prefetch_complete (Prefetch& prefetch, Module* mod, std::exception_ptr ex) noexcept;
+
+	/// Delete the prefetched modules which were not requested.
+	/// 
+	/// \param all If `false`, delete only modules left since the previous call.
+	void discard_prefetched (bool all) noexcept;
+
+	/// Unload the module.
+	/// 
+	/// \param exports_hidden `true` if hide_exports () already published the snapshot without \p pmod.
+	void unload (Module* pmod, bool exports_hidden = false) noexcept;
 
 	BindResult load_and_bind_sync (int32_t mod_id, AccessDirect::_ptr_type binary,
 		const ObjectKey& name, CORBA::Internal::String_in iid);
@@ -501,7 +581,10 @@ private:
 
 private:
 	ObjectMap object_map_;
+	Ref <Snapshot> snapshot_;
+	LockablePtrT <Snapshot> snapshot_ptr_;
 	ModuleMap module_map_;
+	PrefetchMap prefetch_map_;
 	BinaryMap binary_map_;
 	CORBA::Core::RemoteReferences remote_references_;
 	ImplStatic <HousekeepingTimerModules> housekeeping_timer_modules_;
@@ -39,7 +39,7 @@ StaticallyAllocated <ExecDomain::Reschedule> ExecDomain::reschedule_;
 
 void ExecDomain::initialize () noexcept
 {
-	Creator::initialize (EXEC_DOMAIN_POOL_MIN);
+	Creator::initialize (EXEC_DOMAIN_POOL_MIN, "ExecDomain");
 
 	deleter_.construct ();
 	reschedule_.construct ();
@@ -60,6 +60,8 @@ ExecDomain::~ExecDomain ()
 Ref <ExecDomain> ExecDomain::create (const DeadlineTime deadline, Ref <MemContext>&& mem_context)
 {
 	Ref <ExecDomain> ed = Creator::create ();
+	// The pooled object may keep the flag if the previous spawn failed
+	ed->stackless_ = false;
 	Scheduler::activity_begin ();
 	try {
 		ed->deadline_ = deadline;
@@ -126,12 +128,43 @@ void ExecDomain::execute (Thread& thread, Ref <Executor> holder) noexcept
 	thread.exec_domain (*this);
 	if (!impersonation_context_.empty ())
 		Thread::impersonate (impersonation_context_);
-	switch_to ();
+	if (stackless_)
+		run_stackless ();
+	else
+		switch_to ();
 
 	// Perform possible neutral context calls, then return.
 	neutral_context_loop (thread);
 }
 
+inline void ExecDomain::run_stackless () noexcept
+{
+	assert (&ExecContext::current () == &Thread::current ().neutral_context ());
+	assert (runnable_);
+	Runnable* runnable = runnable_;
+	try {
+		ExecContext::run ();
+	} catch (...) {
+		// Short task must not throw exceptions
+		assert (false);
+		runnable_ = nullptr;
+	}
+
+	// Runnable object is always constructed in-place.
+	assert (runnable == (Runnable*)&runnable_space_);
+	runnable->~Runnable ();
+
+	// Release of the own memory context may call SYNC_BEGIN, which needs the fiber.
+	// The sync domain memory context is held by the sync domain.
+	SyncDomain* sd = sync_context_ ? sync_context_->sync_domain () : nullptr;
+	if (mem_context_ && !(sd && &sd->mem_context () == mem_context_)) {
+		stackless_ = false;
+		runnable_ = new (&runnable_space_) FiberCleanup ();
+		switch_to ();
+	} else
+		cleanup ();
+}
+
 inline void ExecDomain::neutral_context_loop (Thread& worker) noexcept
 {
 	assert (&ExecContext::current () == &worker.neutral_context ());
@@ -184,7 +217,12 @@ void ExecDomain::cleanup () noexcept
 
 	resume_exception_.reset ();
 
-	ExecContext::run_in_neutral_context (deleter_);
+	if (stackless_) {
+		// We are already in the neutral context
+		stackless_ = false;
+		deleter_->run ();
+	} else
+		ExecContext::run_in_neutral_context (deleter_);
 }
 
 void ExecDomain::final_release () noexcept
@@ -263,7 +301,8 @@ void ExecDomain::schedule (Ref <SyncContext>& target, bool ret)
 	Ref <SyncDomain> sync_domain = target->sync_domain ();
 	bool background = false;
 	if (!sync_domain) {
-		if (!BACKGROUND_THREAD_DISABLE && INFINITE_DEADLINE == deadline ()) {
+		// Short task never suspends, so it does not need a background thread
+		if (!BACKGROUND_THREAD_DISABLE && INFINITE_DEADLINE == deadline () && !stackless_) {
 			background = true;
 			assert (!ret || background_worker_);
 			if (!ret)
@@ -295,6 +334,12 @@ void ExecDomain::schedule (Ref <SyncContext>& target, bool ret)
 
 void ExecDomain::schedule_call_no_push_mem (SyncContext& target)
 {
+	// Short task can not leave the worker thread stack
+	if (stackless_) {
+		assert (false);
+		throw_BAD_INV_ORDER ();
+	}
+
 	// If old context is a synchronization domain, we
 	// allocate queue node to perform return without a risk
 	// of memory allocation failure.
@@ -407,6 +452,12 @@ bool ExecDomain::suspend_prepare_no_leave (SyncContext* resume_context, bool pus
 	assert (Thread::current ().exec_domain () == this);
 	assert (suspend_state_ == SuspendState::NOT_SUSPENDED);
 
+	// Short task can not suspend
+	if (stackless_) {
+		assert (false);
+		throw_BAD_INV_ORDER ();
+	}
+
 	{ // If a background worker will need for resume, create it now.
 		SyncContext* res_ctx = resume_context;
 		if (!res_ctx)
@@ -473,6 +524,8 @@ void ExecDomain::reschedule () noexcept
 	Thread& thr = Thread::current ();
 	ExecDomain* ed = thr.exec_domain ();
 	assert (ed);
+	if (ed->stackless_)
+		return; // Short task runs to completion
 	if (BACKGROUND_THREAD_DISABLE || &thr != ed->background_worker_) {
 		try {
 			ed->suspend_prepare ();
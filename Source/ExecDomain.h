@@ -37,6 +37,7 @@
 #include "ORB/SystemExceptionHolder.h"
 #include "ConditionalCreator.h"
 #include <limits>
+#include <type_traits>
 #include <utility>
 #include <Nirvana/signal_defs.h>
 
@@ -84,6 +85,8 @@ public:
 	/// \param heap     Shared heap (optional).
 	/// \param args     Arguments for R constructor.
 	/// 
+	/// If R is derived from RunnableShort, it is executed stackless.
+	/// 
 	template <class R, class ... Args>
 	static void async_call (const DeadlineTime& deadline, SyncContext& target, Heap* heap,
 		Args&& ... args)
@@ -92,6 +95,7 @@ public:
 
 		Ref <ExecDomain> exec_domain = create (deadline, get_mem_context (target, heap));
 		exec_domain->runnable_ = new (&exec_domain->runnable_space_) R (std::forward <Args> (args)...);
+		exec_domain->stackless_ = std::is_base_of <RunnableShort, R>::value;
 		exec_domain->spawn (target);
 	}
 
@@ -228,6 +232,12 @@ public:
 	/// Reschedule
 	static void reschedule () noexcept;
 
+	/// \returns `true` if the execution domain runs a short task on the worker thread stack.
+	bool stackless () const noexcept
+	{
+		return stackless_;
+	}
+
 	/// \brief Called from the Port implementation.
 	void run ()
 	{
@@ -456,6 +466,7 @@ private:
 		mem_context_ (nullptr),
 		background_worker_ (nullptr),
 		scheduler_item_created_ (false),
+		stackless_ (false),
 		restricted_mode_ (RestrictedMode::NO_RESTRICTIONS),
 		suspend_state_ (SuspendState::NOT_SUSPENDED)
 #ifndef NDEBUG
@@ -468,6 +479,14 @@ private:
 	using Creator = ConditionalCreator <Ref <ExecDomain>, EXEC_DOMAIN_POOLING>;
 
 	static Ref <ExecDomain> create (const DeadlineTime deadline, Ref <MemContext>&& mem_context);
+
+	/// Get memory context for the call.
+	///
+	/// \param target Target sync context.
+	/// \param heap Heap (optional).
+	/// \returns Sync domain memory context, new memory context for \p heap or `nullptr`.
+	///   If `nullptr` is returned, the memory context with the new heap is created on the first
+	///   mem_context () call only. So the calls which do not use the memory do not create heaps.
 	static Ref <MemContext> get_mem_context (SyncContext& target, Heap* heap = nullptr);
 
 	static Ref <ExecDomain> create (const DeadlineTime deadline, SyncContext& target, Heap* heap = nullptr)
@@ -544,6 +563,9 @@ private:
 	// Perform possible neutral context calls, then return.
 	static void neutral_context_loop (Thread& worker) noexcept;
 
+	// Execute the short task in the neutral context.
+	inline void run_stackless () noexcept;
+
 private:
 	class Schedule : public Runnable
 	{
@@ -570,6 +592,14 @@ private:
 		virtual void run ();
 	};
 
+	// Empty task to run the stackless domain cleanup in the fiber
+	class FiberCleanup : public Runnable
+	{
+	private:
+		virtual void run ()
+		{}
+	};
+
 	class Reschedule : public Runnable
 	{
 	private:
@@ -616,6 +646,9 @@ private:
 
 	bool scheduler_item_created_;
 
+	// The short task is executed in the worker neutral context
+	bool stackless_;
+
 	// Runnables
 	Schedule schedule_;
 	Suspend suspend_;
@@ -33,6 +33,7 @@ namespace Core {
 FileAccessBufData::FileAccessBufData (AccessDirect::_ptr_type acc) noexcept :
 	dirty_begin_ (std::numeric_limits <size_t>::max ()),
 	dirty_end_ (0),
+	buf_size_ (0),
 	own_direct_ (acc)
 {}
 
@@ -126,11 +127,18 @@ uint_fast16_t FileAccessBuf::check_flags (uint_fast16_t f) const
 Bytes::const_iterator FileAccessBuf::get_buffer_read (FileSize pos, size_t cb)
 {
 	while (pos < buf_pos () || pos >= (buf_pos () + buffer ().size ())) {
-		// Out of the old buffer. We must drop old buffer and read a new.
-		
-		if (flush_internal ())
+		// Out of the old buffer.
+
+		if (dirty ()) {
+			// Try to keep the dirty data and read the neighbour region into the buffer.
+			if (extend_buffer (pos, cb))
+				break;
+			flush_internal ();
 			continue; // Buffer position may be changed, do new check
+		}
 
+		// We must drop old buffer and read a new.
+		adapt_buf_size (pos);
 		FileSize new_buf_pos = round_down (pos, (FileSize)blksz ());
 		size_t new_buf_size = cb + (size_t)(pos - new_buf_pos);
 		size_t mbs = min_buf_size ();
@@ -160,8 +168,14 @@ Bytes::iterator FileAccessBuf::get_buffer_write (FileSize pos, size_t cb)
 			FileSize buf_off = pos - buf_pos ();
 			if (buf_off > buffer ().size ())
 				drop_buffer = true;
-			else if (buf_off >= min_buf_size ())
-				drop_buffer = true;
+			else if (buf_off >= min_buf_size ()) {
+				// Sequential write out of the buffer.
+				// Coalesce it with the dirty data while the buffer is not too large.
+				if (dirty () && buf_off + cb <= max_buf_size ())
+					adapt_buf_size (pos);
+				else
+					drop_buffer = true;
+			}
 		}
 
 		if (drop_buffer) {
@@ -169,6 +183,7 @@ Bytes::iterator FileAccessBuf::get_buffer_write (FileSize pos, size_t cb)
 			if (flush_internal ())
 				continue; // Buffer position may be changed, do new check
 
+			adapt_buf_size (pos);
 			FileSize new_buf_pos = round_down (pos, (FileSize)blksz ());
 			size_t read_size = pos - new_buf_pos;
 			if (read_size + cb < min_buf_size ())
@@ -207,6 +222,60 @@ Bytes::iterator FileAccessBuf::get_buffer_write (FileSize pos, size_t cb)
 	return buffer ().begin () + buf_offset;
 }
 
+void FileAccessBuf::adapt_buf_size (const FileSize& pos) noexcept
+{
+	if (!buffer ().empty () && buf_pos () <= pos && pos <= buf_pos () + buffer ().size ()) {
+		// Sequential access
+		size_t size = min_buf_size () * 2;
+		size_t max_size = max_buf_size ();
+		if (size > max_size)
+			size = max_size;
+		buf_size_ = size;
+	} else
+		buf_size_ = 0;
+}
+
+bool FileAccessBuf::extend_buffer (const FileSize& pos, size_t cb)
+{
+	assert (dirty ());
+
+	size_t max_size = max_buf_size ();
+	if (cb >= max_size)
+		return false;
+
+	FileSize buf_end = buf_pos () + buffer ().size ();
+	if (pos >= buf_end) {
+		// Read tail
+		if (pos - buf_end >= min_buf_size ())
+			return false;
+		size_t read_size = (size_t)(round_up (pos + cb, (FileSize)blksz ()) - buf_end);
+		if (read_size < min_buf_size ())
+			read_size = min_buf_size ();
+		if (buffer ().size () + read_size > max_size)
+			return false;
+		Bytes tail;
+		access ()->read (buf_end, (uint32_t)read_size, tail);
+		buffer ().insert (buffer ().end (), tail.begin (), tail.end ());
+		return pos < buf_pos () + buffer ().size ();
+	} else {
+		// Read head
+		assert (pos < buf_pos ());
+		FileSize new_buf_pos = round_down (pos, (FileSize)blksz ());
+		FileSize read_size = buf_pos () - new_buf_pos;
+		if (read_size > min_buf_size () || buffer ().size () + read_size > max_size)
+			return false;
+		Bytes head;
+		access ()->read (new_buf_pos, (uint32_t)read_size, head);
+		if (head.size () != read_size)
+			return false;
+		buffer ().insert (buffer ().begin (), head.begin (), head.end ());
+		buf_pos (new_buf_pos);
+		dirty_begin_ += (size_t)read_size;
+		dirty_end_ += (size_t)read_size;
+		return true;
+	}
+}
+
 void FileAccessBuf::write_internal (const void* p, size_t cb)
 {
 	FileSize pos = position ();
@@ -253,10 +322,22 @@ void FileAccessBuf::shrink_buffer ()
 	size_t mbs = min_buf_size ();
 	while (buffer ().size () > mbs) {
 		size_t drop_size = round_down (buffer ().size () - mbs, (size_t)blksz ());
-		if (drop_size) {
-			if (dirty_begin_ < drop_size && flush_internal ())
+
+		// Do not drop the data after the current position
+		FileSize pos = Servant::position ();
+		if (pos < buf_pos ())
+			drop_size = 0;
+		else if (pos - buf_pos () < drop_size)
+			drop_size = round_down ((size_t)(pos - buf_pos ()), (size_t)blksz ());
+
+		if (dirty_begin_ < drop_size) {
+			if (buffer ().size () <= max_buf_size ())
+				drop_size = round_down (dirty_begin_, (size_t)blksz ()); // Drop the clean head only
+			else if (flush_internal ())
 				continue; // Buffer position may be changed, do new check
+		}
 
+		if (drop_size) {
 			buffer ().erase (buffer ().begin (), buffer ().begin () + drop_size);
 			buffer ().shrink_to_fit ();
 			buf_pos (buf_pos () + drop_size);
@@ -67,6 +67,10 @@ protected:
 
 protected:
 	size_t dirty_begin_, dirty_end_;
+
+	// Adaptive buffer size. 0 means the block size.
+	size_t buf_size_;
+
 	WaitableRef <AccessDirect::_ptr_type> own_direct_;
 };
 
@@ -83,6 +87,9 @@ class FileAccessBuf :
 	// Direct access duplication deadline timeout for sync domains.
 	static const TimeBase::TimeT DIRECT_DUP_TIMEOUT = 100 * TimeBase::MILLISECOND;
 
+	// Maximal size of the buffer for sequential access.
+	static const size_t MAX_BUF_SIZE = 256 * 1024;
+
 public:
 	FileAccessBuf (const FileSize& position, const FileSize& buf_pos, AccessDirect::_ref_type&& access,
 		Bytes&& buffer, uint32_t block_size, uint_fast16_t flags, std::array <char, 2> eol) :
@@ -244,12 +251,30 @@ private:
 
 	void write_internal (const void* p, size_t cb);
 
+	/// \returns Current buffer size, adjusted to the access pattern.
 	size_t min_buf_size () const noexcept
 	{
-		// TODO: Adjust
-		return blksz ();
+		return std::max (buf_size_, (size_t)blksz ());
 	}
 
+	size_t max_buf_size () const noexcept
+	{
+		return std::max (MAX_BUF_SIZE, (size_t)blksz ());
+	}
+
+	/// Adjust the buffer size before the buffer move.
+	/// Sequential access doubles the buffer size up to max_buf_size (),
+	/// random access resets it to the block size.
+	/// 
+	/// \param pos The new access position.
+	void adapt_buf_size (const FileSize& pos) noexcept;
+
+	/// Extend the dirty buffer to the neighbour region instead of the flush.
+	/// So the dirty data are coalesced while the access stays near.
+	/// 
+	/// \returns `true` if buffer now contains \p pos.
+	bool extend_buffer (const FileSize& pos, size_t cb);
+
 	void shrink_buffer ();
 
 	static size_t limit32 (size_t size) noexcept
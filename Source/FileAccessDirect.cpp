@@ -30,6 +30,9 @@
 namespace Nirvana {
 namespace Core {
 
+std::atomic <size_t> FileAccessDirect::dirty_bytes_total_ (0);
+std::atomic <uint64_t> FileAccessDirect::written_bytes_total_ (0);
+
 FileAccessDirect::~FileAccessDirect ()
 {
 	try {
@@ -46,6 +49,10 @@ FileAccessDirect::~FileAccessDirect ()
 		// TODO: Log
 		assert (false);
 	}
+
+	// Unflushed dirty data are lost.
+	// Failed writes completed above could mark more blocks dirty, so subtract at the end.
+	dirty_bytes_total_.fetch_sub (dirty_bytes (), std::memory_order_relaxed);
 }
 
 FileAccessDirect::CacheRange FileAccessDirect::request_read (BlockIdx begin_block, BlockIdx end_block)
@@ -120,8 +127,10 @@ FileAccessDirect::CacheRange FileAccessDirect::request_read (BlockIdx begin_bloc
 void FileAccessDirect::set_dirty (Cache::reference entry, size_t offset, size_t size) noexcept
 {
 	assert (size > 0 && size <= block_size_);
-	if (!entry.second.dirty ())
+	if (!entry.second.dirty ()) {
 		++dirty_blocks_;
+		dirty_bytes_total_.fetch_add (block_size_, std::memory_order_relaxed);
+	}
 	size_t block = offset / base_block_size_;
 	if (entry.second.dirty_begin > block)
 		entry.second.dirty_begin = (uint8_t)block;
@@ -158,6 +167,8 @@ void FileAccessDirect::write_dirty_blocks (SteadyTime timeout)
 				Pos pos = (Pos)first_block->first * (Pos)block_size_ + (Pos)dirty_begin;
 				Size size = (Size)((Pos)(idx - 1) * (Pos)block_size_ + (Pos)dirty_end - pos);
 				Ref <IO_Request> request = Base::write (pos, (uint8_t*)first_block->second.buffer + dirty_begin, size);
+				written_bytes_ += size;
+				written_bytes_total_.fetch_add (size, std::memory_order_relaxed);
 
 				for (Cache::iterator it = first_block; it != block; ++it) {
 					it->second.request = request;
@@ -173,6 +184,28 @@ void FileAccessDirect::write_dirty_blocks (SteadyTime timeout)
 	}
 }
 
+void FileAccessDirect::complete_write_requests ()
+{
+	for (Cache::iterator it = cache_.begin (); it != cache_.end (); ++it) {
+		// Complete pending write requests.
+		if (it->second.request && it->second.request_op == OP_WRITE)
+			complete_request (*it);
+	}
+}
+
+void FileAccessDirect::throttle () noexcept
+{
+	if (dirty_bytes () > dirty_high_watermark_
+		|| (dirty_blocks_ && dirty_bytes_total () > GLOBAL_DIRTY_HIGH_WATERMARK)) {
+		// Write back the dirty data and wait for completion.
+		// The write errors keep blocks dirty and will be reported on flush.
+		try {
+			write_dirty_blocks (0);
+			complete_write_requests ();
+		} catch (...) {}
+	}
+}
+
 void FileAccessDirect::complete_request (Cache::reference entry, int op)
 {
 	while (entry.second.request && (entry.second.request->signalled ()
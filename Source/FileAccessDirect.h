@@ -40,6 +40,15 @@
 namespace Nirvana {
 namespace Core {
 
+/// File segment for the vectored I/O.
+struct FileSegment
+{
+	uint64_t pos;
+	uint32_t size;
+};
+
+typedef std::vector <FileSegment> FileSegments;
+
 class FileAccessDirect :
 	private Port::FileAccessDirect
 {
@@ -53,12 +62,27 @@ public:
 	static const SteadyTime DEFAULT_DISCARD_TIMEOUT = 5000 * TimeBase::MILLISECOND;
 	static const TimeBase::TimeT HOUSEKEEPING_PERIOD = 1000 * TimeBase::MILLISECOND;
 
+	/// Per-file dirty data size above which the writer performs synchronous write-back.
+	static const size_t DEFAULT_DIRTY_HIGH_WATERMARK = 16 * 1024 * 1024;
+
+	/// Per-file dirty data size above which the housekeeping starts write-back.
+	static const size_t DEFAULT_DIRTY_LOW_WATERMARK = 4 * 1024 * 1024;
+
+	/// Dirty data size of all files above which the writers perform synchronous write-back.
+	static const size_t GLOBAL_DIRTY_HIGH_WATERMARK = 256 * 1024 * 1024;
+
+	/// Dirty data size of all files above which the housekeeping starts write-back.
+	static const size_t GLOBAL_DIRTY_LOW_WATERMARK = 64 * 1024 * 1024;
+
 	FileAccessDirect (Port::File& file, uint_fast16_t flags, uint_fast16_t mode) :
 		Base (file, flags, mode, file_size_, base_block_size_),
 		block_size_ (std::max (base_block_size_, (Size)Port::Memory::SHARING_ASSOCIATIVITY)),
 		dirty_blocks_ (0),
+		written_bytes_ (0),
 		write_timeout_ (DEFAULT_WRITE_TIMEOUT),
 		discard_timeout_ (DEFAULT_DISCARD_TIMEOUT),
+		dirty_high_watermark_ (DEFAULT_DIRTY_HIGH_WATERMARK),
+		dirty_low_watermark_ (DEFAULT_DIRTY_LOW_WATERMARK),
 		housekeeping_timer_ (Ref <HousekeepingTimer>::create <ImplDynamic <HousekeepingTimer> > ())
 	{
 		if (block_size_ / base_block_size_ > 128)
@@ -77,6 +101,31 @@ public:
 		return (uint32_t)block_size_;
 	}
 
+	/// \returns Size of the dirty data in the cache of this file.
+	size_t dirty_bytes () const noexcept
+	{
+		return dirty_blocks_ * block_size_;
+	}
+
+	/// \returns Number of bytes written back for this file.
+	uint64_t written_bytes () const noexcept
+	{
+		return written_bytes_;
+	}
+
+	/// \returns Size of the dirty data in the caches of all files.
+	static size_t dirty_bytes_total () noexcept
+	{
+		return dirty_bytes_total_.load (std::memory_order_relaxed);
+	}
+
+	/// \returns Number of bytes written back for all files.
+	/// The write-back rate is the difference of two samples divided by the time interval.
+	static uint64_t written_bytes_total () noexcept
+	{
+		return written_bytes_total_.load (std::memory_order_relaxed);
+	}
+
 	uint64_t size () const noexcept
 	{
 		return file_size_;
@@ -135,6 +184,26 @@ public:
 	inline
 	void write (uint64_t pos, const std::vector <uint8_t>& data, bool sync, const void* proxy);
 
+	/// Scatter read.
+	/// Reads all segments into one buffer. Read requests for all segments are issued before waiting.
+	/// 
+	/// \param segments File segments. Segment sizes are truncated on the end of file.
+	/// \param data Data of all segments are appended to this buffer.
+	/// \param proxy Proxy pointer.
+	inline
+	void read (FileSegments& segments, std::vector <uint8_t>& data, const void* proxy);
+
+	/// Gather write.
+	/// Write-back of the dirty blocks is coalesced into the runs for all segments at once.
+	/// 
+	/// \param segments File segments.
+	/// \param data Data for all segments. Size must be equal to the sum of the segment sizes.
+	/// \param sync Initiate write-back.
+	/// \param proxy Proxy pointer.
+	inline
+	void write (const FileSegments& segments, const std::vector <uint8_t>& data, bool sync,
+		const void* proxy);
+
 	unsigned flags () const noexcept
 	{
 		return Base::flags ();
@@ -260,6 +329,10 @@ private:
 	void clear_cache (BlockIdx excl_begin, BlockIdx excl_end);
 	CacheRange request_read (BlockIdx begin, BlockIdx end);
 
+	inline bool check_read (uint64_t pos, uint32_t& size, const void* proxy) const;
+	inline void read_blocks (CacheRange blocks, uint64_t pos, uint32_t size, std::vector <uint8_t>& data);
+	inline void write_blocks (uint64_t pos, const uint8_t* src_data, size_t src_size);
+
 	void set_dirty (Cache::reference entry, const SteadyTime& time,
 		size_t offset, size_t size) noexcept
 	{
@@ -274,10 +347,22 @@ private:
 			assert (dirty_blocks_);
 			entry.second.dirty_begin = entry.second.dirty_end = 0;
 			--dirty_blocks_;
+			dirty_bytes_total_.fetch_sub (block_size_, std::memory_order_relaxed);
 		}
 	}
 
 	void write_dirty_blocks (SteadyTime timeout);
+	void complete_write_requests ();
+
+	/// If the dirty data size exceeds the high watermark,
+	/// the writer performs synchronous write-back.
+	void throttle () noexcept;
+
+	bool above_low_watermark () const noexcept
+	{
+		return dirty_bytes () > dirty_low_watermark_
+			|| dirty_bytes_total () > GLOBAL_DIRTY_LOW_WATERMARK;
+	}
 
 	static void lock (Cache::reference entry) noexcept {
 		++(entry.second.lock_cnt);
@@ -288,6 +373,13 @@ private:
 		--(entry.second.lock_cnt);
 	}
 
+	static void unlock (CacheRange blocks) noexcept {
+		while (blocks.begin != blocks.end) {
+			unlock (*blocks.begin);
+			++blocks.begin;
+		}
+	}
+
 	void set_size (Pos new_size);
 	void complete_size_request () noexcept;
 	
@@ -335,7 +427,7 @@ private:
 		} catch (...) {}
 
 		try {
-			write_dirty_blocks (write_timeout_);
+			write_dirty_blocks (above_low_watermark () ? 0 : write_timeout_);
 		} catch (...) {}
 	}
 
@@ -349,20 +441,26 @@ private:
 	const Size block_size_;
 	Size base_block_size_;
 	size_t dirty_blocks_;
+	uint64_t written_bytes_;
 	Ref <HousekeepingTimer> housekeeping_timer_;
 
 	const SteadyTime write_timeout_;
 	const SteadyTime discard_timeout_;
+	const size_t dirty_high_watermark_;
+	const size_t dirty_low_watermark_;
+
+	static std::atomic <size_t> dirty_bytes_total_;
+	static std::atomic <uint64_t> written_bytes_total_;
 };
 
 inline
-void FileAccessDirect::read (uint64_t pos, uint32_t size, std::vector <uint8_t>& data, const void* proxy)
+bool FileAccessDirect::check_read (uint64_t pos, uint32_t& size, const void* proxy) const
 {
 	// No data transfer shall occur past the current end-of-file.
 	// If the starting position is at or after the end-of-file, 0 shall be returned.
 	// See https://pubs.opengroup.org/onlinepubs/9699919799/
 	if (pos >= file_size_)
-		return;
+		return false;
 
 	Pos end = add_pos (pos, size);
 	if (end > file_size_) {
@@ -373,14 +471,86 @@ void FileAccessDirect::read (uint64_t pos, uint32_t size, std::vector <uint8_t>&
 	if (!lock_ranges_.check_read (pos, end, proxy))
 		throw_TRANSIENT (EAGAIN);
 
-	BlockIdx begin_block = pos / block_size_, end_block = (end + block_size_ - 1) / block_size_;
+	return true;
+}
+
+inline
+void FileAccessDirect::read (uint64_t pos, uint32_t size, std::vector <uint8_t>& data, const void* proxy)
+{
+	if (!check_read (pos, size, proxy))
+		return;
+
+	BlockIdx begin_block = pos / block_size_, end_block = (pos + size + block_size_ - 1) / block_size_;
 
 	clear_cache (begin_block, end_block);
 
 	if (!size)
 		return;
 
-	CacheRange blocks = request_read (begin_block, end_block);
+	read_blocks (request_read (begin_block, end_block), pos, size, data);
+
+	write_dirty_blocks (write_timeout_);
+}
+
+inline
+void FileAccessDirect::read (FileSegments& segments, std::vector <uint8_t>& data, const void* proxy)
+{
+	// Check all segments before the I/O
+	size_t total = 0;
+	size_t range_cnt = 0;
+	for (FileSegment& seg : segments) {
+		if (!check_read (seg.pos, seg.size, proxy))
+			seg.size = 0;
+		if (seg.size) {
+			total += seg.size;
+			++range_cnt;
+		}
+	}
+
+	if (!range_cnt)
+		return;
+
+	// Issue all read requests at once
+	std::vector <CacheRange> ranges;
+	ranges.reserve (range_cnt);
+	try {
+		for (const FileSegment& seg : segments) {
+			if (seg.size)
+				ranges.push_back (request_read (seg.pos / block_size_,
+					(seg.pos + seg.size + block_size_ - 1) / block_size_));
+		}
+	} catch (...) {
+		for (CacheRange& blocks : ranges) {
+			unlock (blocks);
+		}
+		throw;
+	}
+
+	// Complete requests and copy data
+	data.reserve (data.size () + total);
+	auto range = ranges.begin ();
+	try {
+		for (const FileSegment& seg : segments) {
+			if (seg.size) {
+				read_blocks (*range, seg.pos, seg.size, data);
+				++range;
+			}
+		}
+	} catch (...) {
+		while (ranges.end () != ++range) {
+			unlock (*range);
+		}
+		throw;
+	}
+
+	clear_cache (0, 0);
+	write_dirty_blocks (write_timeout_);
+}
+
+inline
+void FileAccessDirect::read_blocks (CacheRange blocks, uint64_t pos, uint32_t size,
+	std::vector <uint8_t>& data)
+{
 	try {
 		Cache::iterator block = blocks.begin;
 		// Copy first block
@@ -389,7 +559,7 @@ void FileAccessDirect::read (uint64_t pos, uint32_t size, std::vector <uint8_t>&
 			// Reserve space when read across multiple blocks
 			Cache::iterator second_block = block;
 			if (blocks.end != ++second_block)
-				data.reserve (size);
+				data.reserve (data.size () + size);
 			Size off = pos % block_size_;
 			const uint8_t* bl = (uint8_t*)block->second.buffer + off;
 			Size cb = std::min (size, block_size_ - off);
@@ -415,14 +585,9 @@ void FileAccessDirect::read (uint64_t pos, uint32_t size, std::vector <uint8_t>&
 		}
 
 	} catch (...) {
-		while (blocks.begin != blocks.end) {
-			unlock (*blocks.begin);
-			++blocks.begin;
-		}
+		unlock (blocks);
 		throw;
 	}
-
-	write_dirty_blocks (write_timeout_);
 }
 
 inline
@@ -430,16 +595,64 @@ void FileAccessDirect::write (uint64_t pos, const std::vector <uint8_t>& data, b
 {
 	if (pos == std::numeric_limits <uint64_t>::max ())
 		pos = file_size_;
-	Pos end = add_pos (pos, data.size ());
-	BlockIdx cur_block = pos / block_size_;
-	BlockIdx end_block = (end + block_size_ - 1) / block_size_;
 
-	if (!lock_ranges_.check_write (pos, end, proxy))
+	if (!lock_ranges_.check_write (pos, add_pos (pos, data.size ()), proxy))
 		throw_TRANSIENT (EAGAIN);
 
+	write_blocks (pos, data.data (), data.size ());
+
+	write_dirty_blocks (sync ? 0 : write_timeout_);
+	throttle ();
+}
+
+inline
+void FileAccessDirect::write (const FileSegments& segments, const std::vector <uint8_t>& data, bool sync,
+	const void* proxy)
+{
+	// Check all segments before the write.
+	// Append segments are checked at the file size they will see,
+	// as write_blocks () extends file_size_ by each preceding segment.
+	size_t total = 0;
+	Pos file_size = file_size_;
+	for (const FileSegment& seg : segments) {
+		Pos pos = seg.pos;
+		if (pos == std::numeric_limits <uint64_t>::max ())
+			pos = file_size;
+		Pos end = add_pos (pos, seg.size);
+		if (!lock_ranges_.check_write (pos, end, proxy))
+			throw_TRANSIENT (EAGAIN);
+		if (file_size < end)
+			file_size = end;
+		total += seg.size;
+	}
+	if (total != data.size ())
+		throw_BAD_PARAM ();
+
+	// Copy data to cache
+	const uint8_t* src = data.data ();
+	for (const FileSegment& seg : segments) {
+		Pos pos = seg.pos;
+		if (pos == std::numeric_limits <uint64_t>::max ())
+			pos = file_size_;
+		write_blocks (pos, src, seg.size);
+		src += seg.size;
+	}
+
+	// Write dirty blocks, coalesced into runs
+	write_dirty_blocks (sync ? 0 : write_timeout_);
+	throttle ();
+}
+
+inline
+void FileAccessDirect::write_blocks (uint64_t pos, const uint8_t* src_data, size_t src_size)
+{
+	Pos end = add_pos (pos, src_size);
+	BlockIdx cur_block = pos / block_size_;
+	BlockIdx end_block = (end + block_size_ - 1) / block_size_;
+
 	clear_cache (cur_block, end_block);
 
-	if (!data.empty ()) {
+	if (src_size) {
 
 		// If write is not block-aligned, we have to read before write.
 		// As a maximum we need to read 2 blocks: at head and at tail.
@@ -512,8 +725,6 @@ void FileAccessDirect::write (uint64_t pos, const std::vector <uint8_t>& data, b
 				cached_block = cache_.lower_bound (cur_block);
 
 			// Copy data to cache
-			const uint8_t* src_data = data.data ();
-			size_t src_size = data.size ();
 			size_t block_offset = pos % block_size_;
 			for (;; block_offset = 0) {
 				BlockIdx not_cached_end;
@@ -601,20 +812,12 @@ void FileAccessDirect::write (uint64_t pos, const std::vector <uint8_t>& data, b
 			throw;
 		}
 	}
-
-	write_dirty_blocks (sync ? 0 : write_timeout_);
 }
 
 void FileAccessDirect::flush ()
 {
 	write_dirty_blocks (0);
-	
-	for (Cache::iterator it = cache_.begin (); it != cache_.end (); ++it) {
-		// Complete pending write requests.
-		// Do not throw the exceptions.
-		if (it->second.request && it->second.request_op == OP_WRITE)
-			complete_request (*it);
-	}
+	complete_write_requests ();
 	
 	// Set file size if unaligned
 	if (file_size_ % base_block_size_)
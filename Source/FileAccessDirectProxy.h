@@ -95,6 +95,36 @@ public:
 			throw_NO_PERMISSION (make_minor_errno (EBADF));
 	}
 
+	void read (FileSegments& segments, Bytes& data) const
+	{
+		check_exist ();
+
+		if (!(flags_ & O_WRONLY))
+			driver_.read (segments, data, this);
+		else
+			throw_NO_PERMISSION (make_minor_errno (EBADF));
+	}
+
+	void write (const FileSegments& segments, const Bytes& data, bool sync)
+	{
+		check_exist ();
+
+		if (flags_ & O_ACCMODE) {
+			dirty_ = true;
+			if (!sync && flags_ & O_SYNC)
+				sync = true;
+			if (flags_ & O_APPEND) {
+				FileSegments append (segments);
+				for (FileSegment& seg : append) {
+					seg.pos = std::numeric_limits <FileSize>::max ();
+				}
+				driver_.write (append, data, sync, this);
+			} else
+				driver_.write (segments, data, sync, this);
+		} else
+			throw_NO_PERMISSION (make_minor_errno (EBADF));
+	}
+
 	void flush ()
 	{
 		check_exist ();
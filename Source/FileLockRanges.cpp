@@ -25,7 +25,6 @@
 */
 #include "pch.h"
 #include "FileLockRanges.h"
-#include <algorithm>
 
 namespace Nirvana {
 namespace Core {
@@ -40,43 +39,44 @@ bool FileLockRanges::test_lock (const FileSize begin, const FileSize end,
 	LockType level = level_max;
 	int cur_min = (int)LockType::LOCK_EXCLUSIVE + 1, cur_max = (int)LockType::LOCK_NONE;
 
-	// Scan locks
+	// Scan locks from right to left
 	FileSize right = end;
-	const Ranges::const_iterator it_end = lower_bound (end);
-	for (auto it = it_end; ranges_.begin () != it;) {
-		--it;
-		if (it->end > begin) {
-			LockType it_level = it->level;
-			if (it->owner != owner) {
-				// Other lock
-				
-				if (it_level >= LockType::LOCK_PENDING)
-					return false; // Pending lock prohibits new lock
-				else if (it_level == LockType::LOCK_RESERVED) {
-					if (level_min > LockType::LOCK_SHARED)
-						return false;
-					else
-						level = LockType::LOCK_SHARED;
-				} else {
-					// Other shared lock present
-					// We can obtain LOCK_PENDING and below
-					if (LockType::LOCK_PENDING < level_min)
-						return false;
-					if (level > LockType::LOCK_PENDING)
-						level = LockType::LOCK_PENDING;
-				}
+	if (!for_each_overlap (begin, end, [&] (const Node& n) {
+		LockType n_level = n.level;
+		if (n.owner != owner) {
+			// Other lock
+
+			if (n_level >= LockType::LOCK_PENDING)
+				return false; // Pending lock prohibits new lock
+			else if (n_level == LockType::LOCK_RESERVED) {
+				if (level_min > LockType::LOCK_SHARED)
+					return false;
+				else
+					level = LockType::LOCK_SHARED;
 			} else {
-				// Own lock
-				if (cur_max < (int)it_level)
-					cur_max = (int)it_level;
-				if (it->end < right)
-					cur_min = (int)LockType::LOCK_NONE;
-				else if (cur_min > (int)it_level)
-					cur_min = (int)it_level;
-				right = it->begin;
+				// Other shared lock present
+				// We can obtain LOCK_PENDING and below
+				if (LockType::LOCK_PENDING < level_min)
+					return false;
+				if (level > LockType::LOCK_PENDING)
+					level = LockType::LOCK_PENDING;
 			}
+		} else {
+			// Own lock
+			if (cur_max < (int)n_level)
+				cur_max = (int)n_level;
+			if (n.end < right)
+				cur_min = (int)LockType::LOCK_NONE;
+			else if (cur_min > (int)n_level)
+				cur_min = (int)n_level;
+			right = n.begin;
 		}
-	}
+		return true;
+	}))
+		return false;
+
+	if (right > begin) // Not locked head
+		cur_min = (int)LockType::LOCK_NONE;
 
 	// The lock is allowed
 	result.can_set = level;
@@ -93,73 +93,73 @@ bool FileLockRanges::unchecked_set (FileSize begin, FileSize end, const void* ow
 	LockType level)
 {
 	assert (begin < end);
+
+	// Collect own ranges overlapped with or adjacent to [begin, end)
+	std::vector <Node*> own;
+	for_each_own (own_root_, owner, begin, end, [&own] (Node& n) { own.push_back (&n); });
+
+	// Check if we have to split one range into two
+	bool split = false;
+	for (Node* p : own) {
+		if (p->begin <= begin && p->end >= end) {
+			if (p->level == level)
+				return false; // Nothing to change
+			split = p->begin < begin && p->end > end;
+			break;
+		}
+	}
+
+	// We allocate all new nodes before the modification to keep the tree consistent on exception.
+	Node* new_node = nullptr;
+	if (LockType::LOCK_NONE != level)
+		new_node = new Node (begin, end, owner, level, rndgen_ ());
+	Node* tail_node = nullptr;
+	if (split) {
+		try {
+			tail_node = new Node (end, end, owner, level, rndgen_ ());
+		} catch (...) {
+			delete new_node;
+			throw;
+		}
+	}
+
 	bool changed = false;
-	bool insert = true;
-
-	if (LockType::LOCK_NONE != level) // We will insert at most 2 elements
-		ranges_.reserve (ranges_.size () + 2);
-
-	Ranges::iterator it_begin = ranges_.end ();
-	Ranges::iterator it_ub = std::upper_bound (ranges_.begin (), ranges_.end (), end, Comp ());
-	for (auto it = it_ub; ranges_.begin () != it;) {
-		--it;
-		assert (it->begin <= end); // We step left from upper bound
-		if (it->owner == owner) {
-			if (it->end > end) {
-				FileSize tail_end = it->end;
-				LockType tail_level = it->level;
-				if (tail_level == level) {
-					if (it->begin <= begin) {
-						insert = false;
-						break;
-					}
-					--it_ub;
-					it = ranges_.erase (it);
-					end = tail_end;
-					changed = true;
-				} else if (it->begin < end) {
-					--it_ub;
-					it = ranges_.erase (it);
-					ranges_.emplace (std::upper_bound (it, it_ub, end, Comp ()), end, tail_end, owner, tail_level);
-					changed = true;
-				}
-			} else if (it->end >= begin) {
-				if (it->begin > begin) {
-					--it_ub;
-					it = ranges_.erase (it);
-					changed = true;
-				} else {
-					if (it->begin < begin) {
-						if (it->level == level) {
-							changed |= it->end != end;
-							it->end = end;
-							insert = false;
-						} else {
-							it->end = begin;
-							changed = true;
-						}
-					} else {
-						if (level != LockType::LOCK_NONE) {
-							changed |= it->level != level || it->end != end;
-							it->level = level;
-							it->end = end;
-						} else {
-							--it_ub;
-							it = ranges_.erase (it);
-							changed = true;
-						}
-						insert = false;
-					}
-					break;
+	for (Node* p : own) {
+		if (p->level == level) {
+			// Merge with the same level range
+			if (new_node->begin > p->begin)
+				new_node->begin = p->begin;
+			if (new_node->end < p->end)
+				new_node->end = p->end;
+			detach (*p);
+			delete p;
+		} else if (p->begin < end && p->end > begin) {
+			// Cut off the overlapped part of the other level range
+			detach (*p);
+			changed = true;
+			FileSize tail_end = p->end;
+			if (p->begin < begin) {
+				p->end = begin;
+				attach (*p);
+				if (tail_end > end) {
+					assert (tail_node);
+					tail_node->end = tail_end;
+					tail_node->level = p->level;
+					attach (*tail_node);
+					tail_node = nullptr;
 				}
+			} else if (tail_end > end) {
+				p->begin = end;
+				attach (*p);
 			} else
-				break;
+				delete p;
 		}
 	}
 
-	if (insert && level != LockType::LOCK_NONE) {
-		ranges_.emplace (std::upper_bound (ranges_.begin (), it_ub, begin, Comp ()), begin, end, owner,
-			level);
+	assert (!tail_node);
+
+	if (new_node) {
+		attach (*new_node);
 		changed = true;
 	}
 
@@ -176,12 +176,123 @@ bool FileLockRanges::clear_shared_locks (const FileSize& begin, const FileSize&
 	return false;
 }
 
-FileLockRanges::Ranges::iterator FileLockRanges::lower_bound (FileSize end) noexcept
+bool FileLockRanges::delete_all (const void* owner) noexcept
+{
+	bool changed = false;
+	for (;;) {
+		Node* p = own_root_;
+		while (p && p->owner != owner) {
+			if (std::less <const void*> () (owner, p->owner))
+				p = p->own.left;
+			else
+				p = p->own.right;
+		}
+		if (!p)
+			break;
+		detach (*p);
+		delete p;
+		changed = true;
+	}
+	return changed;
+}
+
+void FileLockRanges::attach (Node& node) noexcept
+{
+	assert (!node.pos.left && !node.pos.right && !node.own.left && !node.own.right);
+	pos_root_ = insert <PosTree> (pos_root_, node);
+	own_root_ = insert <OwnTree> (own_root_, node);
+}
+
+void FileLockRanges::detach (Node& node) noexcept
+{
+	pos_root_ = erase <PosTree> (pos_root_, node);
+	own_root_ = erase <OwnTree> (own_root_, node);
+	node.pos = node.own = { nullptr, nullptr };
+}
+
+template <class Tree>
+FileLockRanges::Node* FileLockRanges::insert (Node* root, Node& node) noexcept
+{
+	if (!root) {
+		Tree::update (node);
+		return &node;
+	}
+	if (node.priority > root->priority) {
+		Link& link = Tree::link (node);
+		split <Tree> (root, node, link.left, link.right);
+		Tree::update (node);
+		return &node;
+	}
+	Link& link = Tree::link (*root);
+	if (Tree::less (node, *root))
+		link.left = insert <Tree> (link.left, node);
+	else
+		link.right = insert <Tree> (link.right, node);
+	Tree::update (*root);
+	return root;
+}
+
+template <class Tree>
+FileLockRanges::Node* FileLockRanges::erase (Node* root, const Node& node) noexcept
 {
-	if (end == std::numeric_limits <FileSize>::max ())
-		return ranges_.end ();
+	assert (root);
+	Link& link = Tree::link (*root);
+	if (root == &node)
+		return merge <Tree> (link.left, link.right);
+	if (Tree::less (node, *root))
+		link.left = erase <Tree> (link.left, node);
 	else
-		return std::lower_bound (ranges_.begin (), ranges_.end (), end, Comp ());
+		link.right = erase <Tree> (link.right, node);
+	Tree::update (*root);
+	return root;
+}
+
+template <class Tree>
+void FileLockRanges::split (Node* root, const Node& key, Node*& l, Node*& r) noexcept
+{
+	if (!root) {
+		l = r = nullptr;
+		return;
+	}
+	Link& link = Tree::link (*root);
+	if (Tree::less (*root, key)) {
+		split <Tree> (link.right, key, link.right, r);
+		l = root;
+	} else {
+		split <Tree> (link.left, key, l, link.left);
+		r = root;
+	}
+	Tree::update (*root);
+}
+
+template <class Tree>
+FileLockRanges::Node* FileLockRanges::merge (Node* l, Node* r) noexcept
+{
+	if (!l)
+		return r;
+	if (!r)
+		return l;
+	if (l->priority > r->priority) {
+		Link& link = Tree::link (*l);
+		link.right = merge <Tree> (link.right, r);
+		Tree::update (*l);
+		return l;
+	} else {
+		Link& link = Tree::link (*r);
+		link.left = merge <Tree> (l, link.left);
+		Tree::update (*r);
+		return r;
+	}
+}
+
+void FileLockRanges::destroy (Node* root) noexcept
+{
+	while (root) {
+		destroy (root->pos.left);
+		Node* right = root->pos.right;
+		delete root;
+		root = right;
+	}
 }
 
 }
@@ -30,14 +30,35 @@
 
 #include <Nirvana/Nirvana.h>
 #include <Nirvana/File.h>
+#include <Nirvana/RandomGen.h>
 #include <vector>
 
 namespace Nirvana {
 namespace Core {
 
+/// File byte range locks.
+/// 
+/// Locks are stored in the augmented interval tree (treap ordered by range begin,
+/// each node keeps the maximal range end of the subtree).
+/// So the overlap queries cost O (log n + k) where k is number of the overlapped ranges.
+/// The same nodes are linked into the second treap ordered by owner,
+/// to enumerate and delete locks of one owner without full scan.
 class FileLockRanges
 {
 public:
+	FileLockRanges () noexcept :
+		pos_root_ (nullptr),
+		own_root_ (nullptr)
+	{}
+
+	~FileLockRanges ()
+	{
+		destroy (pos_root_);
+	}
+
+	FileLockRanges (const FileLockRanges&) = delete;
+	FileLockRanges& operator = (const FileLockRanges&) = delete;
+
 	struct TestResult
 	{
 		LockType can_set, cur_max, cur_min;
@@ -72,27 +93,22 @@ public:
 	{
 		assert (begin < end);
 		assert (level > LockType::LOCK_NONE);
-		Ranges::const_iterator found = ranges_.end ();
-		for (auto it = lower_bound (end); ranges_.begin () != it; ) {
-			--it;
-			if (it->end > begin && it->owner != owner) {
-				LockType other_level = it->level;
-				if (other_level >= LockType::LOCK_PENDING) {
-					found = it;
-					break;
-				} else if (other_level > LockType::LOCK_SHARED) {
-					if (level > LockType::LOCK_SHARED) {
-						found = it;
-						break;
-					}
-				} else if (level == LockType::LOCK_EXCLUSIVE) {
-					found = it;
-					break;
+		const Node* found = nullptr;
+		for_each_overlap (begin, end, [owner, level, &found] (const Node& n) {
+			if (n.owner != owner) {
+				LockType other_level = n.level;
+				if (other_level >= LockType::LOCK_PENDING
+					|| (other_level > LockType::LOCK_SHARED && level > LockType::LOCK_SHARED)
+					|| level == LockType::LOCK_EXCLUSIVE
+				) {
+					found = &n;
+					return false;
 				}
 			}
-		}
+			return true;
+		});
 
-		if (found != ranges_.end ()) {
+		if (found) {
 			out.start (found->begin);
 			out.len (found->end == std::numeric_limits <FileSize>::max () ? 0 : found->end - found->begin);
 			out.type (found->level);
@@ -103,47 +119,27 @@ public:
 
 	bool check_read (const FileSize& begin, const FileSize& end, const void* owner) const noexcept
 	{
-		Ranges::const_iterator it = lower_bound (end);
-		while (it != ranges_.begin ()) {
-			--it;
-			if (it->end > begin && it->level == LockType::LOCK_EXCLUSIVE && it->owner != owner)
-				return false;
-		}
-		return true;
+		return for_each_overlap (begin, end, [owner] (const Node& n) {
+			return !(n.level == LockType::LOCK_EXCLUSIVE && n.owner != owner);
+		});
 	}
 
 	bool check_write (const FileSize& begin, const FileSize& end, const void* owner) const noexcept
 	{
-		Ranges::const_iterator it = lower_bound (end);
-		while (it != ranges_.begin ()) {
-			--it;
-			if (it->end > begin && (it->level < LockType::LOCK_EXCLUSIVE || it->owner != owner))
-				return false;
-		}
-		return true;
+		return for_each_overlap (begin, end, [owner] (const Node& n) {
+			return !(n.level < LockType::LOCK_EXCLUSIVE || n.owner != owner);
+		});
 	}
 
-	bool delete_all (const void* owner) noexcept
-	{
-		bool changed = false;
-		for (auto it = ranges_.rbegin (); it != ranges_.rend (); ++it) {
-			if (it->owner == owner) {
-				changed = true;
-				ranges_.erase (it.base ());
-			}
-		}
-		return changed;
-	}
+	bool delete_all (const void* owner) noexcept;
 
 	std::vector <FileLock> get_all (const void* owner) const
 	{
 		std::vector <FileLock> ret;
-		for (const Entry& e : ranges_) {
-			if (e.owner == owner) {
-				ret.emplace_back (e.begin, e.end == std::numeric_limits <FileSize>::max ()
-					? 0 : e.end - e.begin, e.level);
-			}
-		}
+		for_each_own (own_root_, owner, 0, std::numeric_limits <FileSize>::max (), [&ret] (Node& n) {
+			ret.emplace_back (n.begin, n.end == std::numeric_limits <FileSize>::max ()
+				? 0 : n.end - n.begin, n.level);
+		});
 		return ret;
 	}
 
@@ -153,73 +149,178 @@ private:
 	bool has_shared_locks_only (const FileSize& begin, const FileSize& end, const void* owner) const noexcept
 	{
 		bool ret = false;
-		const Ranges::const_iterator it_end = lower_bound (end);
-		for (auto it = it_end; ranges_.begin () != it;) {
-			--it;
-			if (it->end > begin) {
-				if (it->owner == owner) {
-					if (it->level == LockType::LOCK_SHARED)
-						ret = true;
-					else {
-						ret = false;
-						break;
-					}
+		for_each_overlap (begin, end, [owner, &ret] (const Node& n) {
+			if (n.owner == owner) {
+				if (n.level == LockType::LOCK_SHARED)
+					ret = true;
+				else {
+					ret = false;
+					return false;
 				}
 			}
-		}
+			return true;
+		});
 		return ret;
 	}
 
 private:
-	struct Entry {
+	struct Node;
+
+	struct Link
+	{
+		Node* left;
+		Node* right;
+	};
+
+	struct Node
+	{
 		FileSize begin;
 		FileSize end;
 		const void* owner;
 		LockType level;
 
-		Entry (const FileSize& _begin, const FileSize& _end, const void* _owner, LockType _level)
-			noexcept :
+		/// Maximal `end` in the subtree of the position tree.
+		FileSize max_end;
+
+		/// Treap priority.
+		RandomGen::result_type priority;
+
+		/// Position tree links.
+		Link pos;
+
+		/// Owner tree links.
+		Link own;
+
+		Node (const FileSize& _begin, const FileSize& _end, const void* _owner, LockType _level,
+			RandomGen::result_type _priority) noexcept :
 			begin (_begin),
 			end (_end),
 			owner (_owner),
-			level (_level)
+			level (_level),
+			max_end (_end),
+			priority (_priority),
+			pos { nullptr, nullptr },
+			own { nullptr, nullptr }
 		{}
+	};
 
-		bool operator < (const Entry& rhs) const noexcept
+	/// Position tree traits. Ordered by (begin, owner).
+	struct PosTree
+	{
+		static Link& link (Node& n) noexcept
 		{
-			return begin < rhs.begin;
+			return n.pos;
 		}
-	};
 
-	struct Comp
-	{
-		bool operator () (const Entry& l, const Entry& r) const noexcept
+		static bool less (const Node& l, const Node& r) noexcept
+		{
+			if (l.begin < r.begin)
+				return true;
+			else if (l.begin > r.begin)
+				return false;
+			else
+				return std::less <const void*> () (l.owner, r.owner);
+		}
+
+		static void update (Node& n) noexcept
 		{
-			return l.begin < r.begin;
+			FileSize max_end = n.end;
+			if (n.pos.left && max_end < n.pos.left->max_end)
+				max_end = n.pos.left->max_end;
+			if (n.pos.right && max_end < n.pos.right->max_end)
+				max_end = n.pos.right->max_end;
+			n.max_end = max_end;
 		}
+	};
 
-		bool operator () (const Entry& l, const FileSize& r) const noexcept
+	/// Owner tree traits. Ordered by (owner, begin).
+	struct OwnTree
+	{
+		static Link& link (Node& n) noexcept
 		{
-			return l.begin < r;
+			return n.own;
 		}
 
-		bool operator () (const FileSize& l, const Entry& r) const noexcept
+		static bool less (const Node& l, const Node& r) noexcept
 		{
-			return l < r.begin;
+			if (l.owner != r.owner)
+				return std::less <const void*> () (l.owner, r.owner);
+			else
+				return l.begin < r.begin;
 		}
+
+		static void update (Node&) noexcept
+		{}
 	};
 
-	typedef std::vector <Entry> Ranges;
+	template <class Tree>
+	static Node* insert (Node* root, Node& node) noexcept;
+
+	template <class Tree>
+	static Node* erase (Node* root, const Node& node) noexcept;
 
-	Ranges::iterator lower_bound (FileSize end) noexcept;
+	template <class Tree>
+	static void split (Node* root, const Node& key, Node*& l, Node*& r) noexcept;
 
-	Ranges::const_iterator lower_bound (const FileSize& end) const noexcept
+	template <class Tree>
+	static Node* merge (Node* l, Node* r) noexcept;
+
+	static void destroy (Node* root) noexcept;
+
+	/// Calls f for each range overlapped with [begin, end) in the descending `begin` order.
+	/// 
+	/// \param f Functor `bool f (const Node&)`. Return `false` to stop the iteration.
+	/// \returns `false` if iteration was stopped by f.
+	template <class F>
+	bool for_each_overlap (const FileSize& begin, const FileSize& end, F f) const noexcept
+	{
+		return for_each_overlap (pos_root_, begin, end, f);
+	}
+
+	template <class F>
+	static bool for_each_overlap (const Node* p, const FileSize& begin, const FileSize& end, F& f)
+		noexcept
+	{
+		while (p && p->max_end > begin) {
+			if (p->begin < end) {
+				if (!for_each_overlap (p->pos.right, begin, end, f))
+					return false;
+				if (p->end > begin && !f (*p))
+					return false;
+			}
+			p = p->pos.left;
+		}
+		return true;
+	}
+
+	/// Calls f for each range of the owner where end >= begin and begin <= end,
+	/// in the ascending order.
+	template <class F>
+	static void for_each_own (Node* p, const void* owner, const FileSize& begin, const FileSize& end,
+		F&& f)
 	{
-		return const_cast <FileLockRanges&> (*this).lower_bound (end);
+		while (p) {
+			if (std::less <const void*> () (p->owner, owner)
+				|| (p->owner == owner && p->end < begin))
+				p = p->own.right;
+			else if (std::less <const void*> () (owner, p->owner)
+				|| (p->owner == owner && p->begin > end))
+				p = p->own.left;
+			else {
+				for_each_own (p->own.left, owner, begin, end, f);
+				f (*p);
+				p = p->own.right;
+			}
+		}
 	}
 
+	void attach (Node& node) noexcept;
+	void detach (Node& node) noexcept;
+
 private:
-	Ranges ranges_;
+	Node* pos_root_;
+	Node* own_root_;
+	RandomGen rndgen_;
 };
 
 }
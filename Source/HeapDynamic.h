@@ -48,7 +48,7 @@ class HeapDynamic :
 public:
 	static void initialize ()
 	{
-		Creator::initialize (HEAP_POOL_MIN);
+		Creator::initialize (HEAP_POOL_MIN, "Heap");
 	}
 
 	static void terminate () noexcept
@@ -74,6 +74,8 @@ private:
 	void _remove_ref () noexcept override
 	{
 		if (0 == ref_cnt_.decrement_seq ()) {
+			// The pooled heap keeps the first partition, so the reused heap
+			// does not create the partition again on the first allocation.
 			cleanup (!HEAP_POOLING);
 			Creator::release (this);
 		}
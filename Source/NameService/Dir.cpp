@@ -44,6 +44,39 @@ void Dir::check_name (const CosNaming::Name& n) const
 	Base::check_name (n);
 }
 
+Nirvana::DirItem::_ref_type Dir::resolve_const (Name& n) const
+{
+	PathCache& cache = FileSystem::path_cache ();
+	PathCache::Key key;
+	PathCache::make_key (id (), n, key);
+	DirItemId item_id;
+	BindingType type;
+	size_t missing;
+	unsigned generation;
+	if (cache.find (key, item_id, type, missing, generation)) {
+		if (missing) {
+			assert (missing <= n.size ());
+			n.erase (n.begin (), n.end () - missing);
+			throw NamingContext::NotFound (NamingContext::NotFoundReason::missing_node, std::move (n));
+		}
+		return FileSystem::get_reference (item_id, type);
+	}
+
+	try {
+		item_id = Base::resolve_path (n);
+	} catch (const NamingContext::NotFound& ex) {
+		if (NamingContext::NotFoundReason::missing_node == ex.why ()
+			&& !ex.rest_of_name ().empty ())
+			cache.insert (std::move (key), DirItemId (), BindingType::nobject,
+				ex.rest_of_name ().size (), generation);
+		throw;
+	}
+	type = FileSystem::get_item_type (item_id) == Nirvana::FileType::directory ?
+		BindingType::ncontext : BindingType::nobject;
+	cache.insert (std::move (key), item_id, type, 0, generation);
+	return FileSystem::get_reference (item_id, type);
+}
+
 inline
 void Dir::bind_file (Name& n, Object::_ptr_type obj, bool rebind)
 {
@@ -54,6 +87,7 @@ void Dir::bind_file (Name& n, Object::_ptr_type obj, bool rebind)
 		etherealize ();
 		throw;
 	}
+	FileSystem::paths_changed ();
 }
 
 void Dir::bind_dir (Name& n, Object::_ptr_type obj, bool rebind)
@@ -65,6 +99,7 @@ void Dir::bind_dir (Name& n, Object::_ptr_type obj, bool rebind)
 		etherealize ();
 		throw;
 	}
+	FileSystem::paths_changed ();
 }
 
 void Dir::bind (Name& n, Object::_ptr_type obj, bool rebind)
@@ -89,6 +124,7 @@ void Dir::bind_context (Name& n, NamingContext::_ptr_type nc, bool rebind)
 
 void Dir::etherealize ()
 {
+	FileSystem::paths_changed ();
 	Base::etherealize ();
 	_default_POA ()->deactivate_object (id ());
 }
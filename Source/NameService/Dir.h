@@ -150,15 +150,19 @@ public:
 	}
 
 	// This method must be really const to avoid race condition in iterator.
-	Nirvana::DirItem::_ref_type resolve_const (CosNaming::Name& n) const
+	Nirvana::DirItem::_ref_type resolve_const (CosNaming::Name& n) const;
+
+	// Resolve the item with known binding type, used by the iterator.
+	Nirvana::DirItem::_ref_type resolve_const (CosNaming::Name& n, CosNaming::BindingType type) const
 	{
-		return FileSystem::get_reference (Base::resolve_path (n));
+		return FileSystem::get_reference (Base::resolve_path (n), type);
 	}
 
 	void unbind (CosNaming::Name& n)
 	{
 		check_name (n);
 		Base::unlink (n);
+		FileSystem::paths_changed ();
 	}
 
 	CosNaming::NamingContext::_ref_type bind_new_context (CosNaming::Name& n)
@@ -168,6 +172,7 @@ public:
 		try {
 			if (!Base::create_dir (n, 0, &id))
 				throw CosNaming::NamingContext::AlreadyBound ();
+			FileSystem::path_created ();
 		} catch (const CORBA::OBJECT_NOT_EXIST&) {
 			etherealize ();
 			throw;
@@ -194,7 +199,9 @@ public:
 		for (;;) {
 			if (flags & O_CREAT) {
 				try {
-					return FileSystem::get_file (get_new_file_id (n))->open (flags, mode);
+					Access::_ref_type acc = FileSystem::get_file (get_new_file_id (n))->open (flags, mode);
+					FileSystem::path_created ();
+					return acc;
 				} catch (const CORBA::SystemException& err) {
 					if ((flags & O_EXCL) || get_minor_errno (err.minor ()) != EEXIST)
 						throw;
@@ -262,6 +269,7 @@ public:
 					throw;
 			}
 			if (acc) {
+				FileSystem::path_created ();
 				std::copy (p_start, p_end, name_p + pattern_start);
 				return acc;
 			}
@@ -275,7 +283,10 @@ public:
 	{
 		check_name (n);
 		try {
-			return Base::create_dir (n, mode, nullptr);
+			bool created = Base::create_dir (n, mode, nullptr);
+			if (created)
+				FileSystem::path_created ();
+			return created;
 		} catch (const CORBA::OBJECT_NOT_EXIST&) {
 			etherealize ();
 			throw;
@@ -305,8 +316,11 @@ inline
 DirIter::DirIter (Dir& dir, const std::string& regexp, unsigned flags) :
 	dir_ (dir),
 	iterator_ (dir.make_iterator ()),
-	flags_ (flags & ~USE_REGEX)
+	flags_ (flags & ~(USE_REGEX | USE_STAT))
 {
+	if (iterator_ && iterator_->stat_supported ())
+		flags_ |= USE_STAT;
+
 	if (!regexp.empty () && regexp != "*" && regexp != "*.*") {
 		flags_ |= USE_REGEX;
 		throw_NO_IMPLEMENT (make_minor_errno (ENOSYS)); // TODO: Implement.
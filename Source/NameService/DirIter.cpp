@@ -39,7 +39,15 @@ bool DirIter::next_one (DirEntry& de)
 		return false;
 
 	CosNaming::Core::Iterator::Binding b;
-	while (iterator_->next_one (b)) {
+	for (;;) {
+		// If the port iterator obtains the attributes together with the names,
+		// we get the whole entry in one sweep.
+		if (flags_ & USE_STAT) {
+			if (!iterator_->next_stat (b, de.st ()))
+				break;
+		} else if (!iterator_->next_one (b))
+			break;
+
 /*
 		if (flags_ & USE_REGEX) {
 		size_t cc = b.name.id ().size ();
@@ -57,23 +65,12 @@ bool DirIter::next_one (DirEntry& de)
 		}
 */
 
-		Name n (1, b.name);
-
-		try {
-			DirItem::_ref_type item = dir_.resolve_const (n);
-			item->stat (de.st ());
-			de.name (std::move (b.name));
-		} catch (const NamingContext::NotFound&) {
+		if (!(flags_ & USE_STAT) && !stat (b, de.st ())) {
 			b.clear ();
-			continue; // Item was deleted
-		} catch (const CORBA::NO_PERMISSION&) {
-			if (flags_ & Nirvana::Dir::SKIP_PERMISSION_DENIED) {
-				b.clear ();
-				continue;
-			}
-			throw;
+			continue;
 		}
 
+		de.name (std::move (b.name));
 		return true;
 	}
 
@@ -81,20 +78,39 @@ bool DirIter::next_one (DirEntry& de)
 	return false;
 }
 
+bool DirIter::stat (CosNaming::Core::Iterator::Binding& b, FileStat& st)
+{
+	Name n (1, b.name);
+
+	try {
+		dir_.resolve_const (n, b.type)->stat (st);
+	} catch (const NamingContext::NotFound&) {
+		return false; // Item was deleted
+	} catch (const CORBA::NO_PERMISSION&) {
+		if (flags_ & Nirvana::Dir::SKIP_PERMISSION_DENIED)
+			return false;
+		throw;
+	}
+	return true;
+}
+
 bool DirIter::next_n (uint32_t how_many, DirEntryList& l)
 {
 	if (end ())
 		return false;
 
-	l.reserve (std::min (how_many, 1024u));
+	l.reserve (l.size () + std::min (how_many, 1024u));
 
-	bool ret = false;
-	DirEntry entry;
-	while (how_many-- && next_one (entry)) {
-		l.push_back (std::move (entry));
-		ret = true;
+	// Fill the list entries in place
+	size_t cnt = l.size ();
+	while (how_many--) {
+		l.emplace_back ();
+		if (!next_one (l.back ())) {
+			l.pop_back ();
+			break;
+		}
 	}
-	return ret;
+	return l.size () > cnt;
 }
 
 class DirIterator :
@@ -31,16 +31,9 @@
 #include <Nirvana/Nirvana.h>
 #include <Nirvana/File.h>
 #include "../CoreInterface.h"
+#include "Iterator.h"
 #include <memory>
 
-namespace CosNaming {
-namespace Core {
-
-class Iterator;
-
-}
-}
-
 namespace Nirvana {
 namespace Core {
 
@@ -61,12 +54,16 @@ public:
 		return !iterator_;
 	}
 
+private:
+	bool stat (CosNaming::Core::Iterator::Binding& b, FileStat& st);
+
 private:
 	Dir& dir_;
 	std::unique_ptr <CosNaming::Core::Iterator> iterator_;
 	unsigned flags_;
 
 	static const unsigned USE_REGEX = 0x8000;
+	static const unsigned USE_STAT = 0x4000;
 };
 
 }
@@ -37,6 +37,7 @@ void File::check_exist ()
 
 void File::etherealize ()
 {
+	FileSystem::paths_changed ();
 	Base::etherealize ();
 	_default_POA ()->deactivate_object (id ());
 }
@@ -134,6 +134,8 @@ public:
 		if (!access_) {
 			try {
 				access_ = std::make_unique <Nirvana::Core::FileAccessDirect> (std::ref (port ()), flags, mode);
+				if (flags & O_CREAT)
+					FileSystem::path_created ();
 			} catch (const CORBA::OBJECT_NOT_EXIST&) {
 				etherealize ();
 				throw;
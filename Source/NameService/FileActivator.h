@@ -42,11 +42,13 @@ public:
 	static void initialize () noexcept
 	{
 		Nirvana::Core::FileSystem::adapter_.construct ();
+		Nirvana::Core::FileSystem::path_cache_.construct ();
 	}
 
 	static void terminate () noexcept
 	{
 		Nirvana::Core::FileSystem::adapter_ = nullptr;
+		Nirvana::Core::FileSystem::path_cache_.destruct ();
 	}
 
 	PortableServer::ServantBase::_ref_type incarnate (const ObjectId& id, POA::_ptr_type adapter)
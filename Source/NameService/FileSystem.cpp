@@ -38,6 +38,7 @@ namespace Core {
 
 const char FileSystem::adapter_name_ [] = "_fs";
 StaticallyAllocated <POA::_ref_type> FileSystem::adapter_;
+StaticallyAllocated <PathCache> FileSystem::path_cache_;
 
 Object::_ref_type FileSystem::get_reference (const DirItemId& id, Internal::String_in iid)
 {
@@ -67,7 +68,13 @@ Nirvana::File::_ref_type FileSystem::get_file (const DirItemId& id)
 
 Nirvana::DirItem::_ref_type FileSystem::get_reference (const DirItemId& id)
 {
-	Object::_ref_type obj = get_reference (id, get_item_type (id) == Nirvana::FileType::directory ?
+	return get_reference (id, get_item_type (id) == Nirvana::FileType::directory ?
+		BindingType::ncontext : BindingType::nobject);
+}
+
+Nirvana::DirItem::_ref_type FileSystem::get_reference (const DirItemId& id, BindingType type)
+{
+	Object::_ref_type obj = get_reference (id, BindingType::ncontext == type ?
 		Internal::RepIdOf <Nirvana::Dir>::id : Internal::RepIdOf <Nirvana::File>::id);
 	assert (obj);
 	Nirvana::DirItem::_ref_type item = Nirvana::DirItem::_narrow (obj);
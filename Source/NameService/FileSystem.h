@@ -33,6 +33,7 @@
 #include "../Synchronized.h"
 #include "../ORB/Services.h"
 #include "NamingContextBase.h"
+#include "PathCache.h"
 #include <Nirvana/File_s.h>
 #include <CORBA/NoDefaultPOA.h>
 #include <Nirvana/posix_defs.h>
@@ -95,6 +96,10 @@ public:
 	}
 
 	static Nirvana::DirItem::_ref_type get_reference (const DirItemId& id);
+
+	/// Get reference for the item with known binding type.
+	/// Saves the item type query to the port file system.
+	static Nirvana::DirItem::_ref_type get_reference (const DirItemId& id, CosNaming::BindingType type);
 	static Nirvana::Dir::_ref_type get_dir (const DirItemId& id);
 	static Nirvana::File::_ref_type get_file (const DirItemId& id);
 
@@ -108,6 +113,24 @@ public:
 		Port::FileSystem::etherealize (id, servant);
 	}
 
+	/// Path resolution cache.
+	static PathCache& path_cache () noexcept
+	{
+		return path_cache_;
+	}
+
+	/// Invalidate path resolution cache on the name space modification.
+	static void paths_changed () noexcept
+	{
+		path_cache_->clear ();
+	}
+
+	/// Invalidate negative path resolution cache entries on the item creation.
+	static void path_created () noexcept
+	{
+		path_cache_->clear_negative ();
+	}
+
 	static PortableServer::POA::_ref_type& adapter () noexcept
 	{
 		assert ((PortableServer::POA::_ref_type&)adapter_);
@@ -247,6 +270,7 @@ private:
 
 	friend class PortableServer::Core::FileActivator;
 	static Nirvana::Core::StaticallyAllocated <PortableServer::POA::_ref_type> adapter_;
+	static Nirvana::Core::StaticallyAllocated <PathCache> path_cache_;
 };
 
 }
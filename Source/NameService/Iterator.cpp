@@ -54,6 +54,12 @@ bool Iterator::next_one (CosNaming::Binding& b)
 	return false;
 }
 
+bool Iterator::next_stat (Binding&, Nirvana::FileStat&)
+{
+	assert (!stat_supported ());
+	throw CORBA::NO_IMPLEMENT ();
+}
+
 bool Iterator::next_n (uint32_t how_many, CosNaming::BindingList& bl)
 {
 	if (end ())
@@ -30,6 +30,7 @@
 
 #include <CORBA/CORBA.h>
 #include <CORBA/CosNaming.h>
+#include <Nirvana/File.h>
 #include "../UserObject.h"
 #include <memory>
 
@@ -69,6 +70,22 @@ public:
 	};
 
 	virtual bool next_one (Binding& b) = 0;
+
+	/// \returns `true` if the iterator supports next_stat ().
+	///
+	/// File system iterators which obtain the item attributes together with the names
+	/// in one directory sweep override this method.
+	virtual bool stat_supported () const noexcept
+	{
+		return false;
+	}
+
+	/// Get next binding with the item attributes.
+	///
+	/// \param [out] b Binding.
+	/// \param [out] st Item attributes.
+	/// \returns `false` if there are no more bindings.
+	virtual bool next_stat (Binding& b, Nirvana::FileStat& st);
 };
 
 }
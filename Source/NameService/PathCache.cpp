@@ -0,0 +1,134 @@
+/*
+* Nirvana Core.
+*
+* This is a part of the Nirvana project.
+*
+* Author: Igor Popov
+*
+* Copyright (c) 2025 Igor Popov.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*
+* Send comments and/or bug reports to:
+*  popov.nirvana@gmail.com
+*/
+#include "../pch.h"
+#include "PathCache.h"
+#include "../BackOff.h"
+#include "../Chrono.h"
+
+namespace Nirvana {
+namespace Core {
+
+void PathCache::make_key (const DirItemId& dir, const CosNaming::Name& n, Key& key)
+{
+	size_t size = dir.size ();
+	for (const auto& nc : n) {
+		size += nc.id ().size () + nc.kind ().size () + 2;
+	}
+	key.clear ();
+	key.reserve (size);
+	key.assign ((const char*)dir.data (), dir.size ());
+	for (const auto& nc : n) {
+		key += '/';
+		key.append (nc.id ().data (), nc.id ().size ());
+		if (!nc.kind ().empty ()) {
+			key += '.';
+			key.append (nc.kind ().data (), nc.kind ().size ());
+		}
+	}
+}
+
+bool PathCache::find (const Key& key, DirItemId& id, CosNaming::BindingType& type, size_t& missing,
+	unsigned& generation)
+{
+	DeadlineTime now = Chrono::deadline_clock ();
+	bool found = false;
+	lock ();
+	auto it = map_.find (key);
+	if (it != map_.end ()) {
+		if (it->second.expire > now) {
+			try {
+				id.assign (it->second.id.begin (), it->second.id.end ());
+			} catch (...) {
+				unlock ();
+				throw;
+			}
+			type = it->second.type;
+			missing = it->second.missing;
+			found = true;
+		} else
+			map_.erase (it);
+	}
+	generation = generation_;
+	unlock ();
+	return found;
+}
+
+void PathCache::insert (Key&& key, const DirItemId& id, CosNaming::BindingType type, size_t missing,
+	unsigned generation)
+{
+	// Entry lifetime is one second
+	DeadlineTime expire = Chrono::deadline_clock () + Chrono::deadline_clock_frequency ();
+
+	lock ();
+	try {
+		if (generation == generation_) {
+			if (map_.size () >= MAX_ENTRIES)
+				map_.clear ();
+			Entry& entry = map_ [std::move (key)];
+			entry.id.assign (id.begin (), id.end ());
+			entry.expire = expire;
+			entry.missing = missing;
+			entry.type = type;
+		}
+	} catch (...) {
+		// Cache is an optimization, ignore the memory errors
+	}
+	unlock ();
+}
+
+void PathCache::clear () noexcept
+{
+	lock ();
+	++generation_;
+	map_.clear ();
+	unlock ();
+}
+
+void PathCache::clear_negative () noexcept
+{
+	lock ();
+	++generation_;
+	for (auto it = map_.begin (); it != map_.end ();) {
+		if (it->second.missing)
+			map_.erase (it++);
+		else
+			++it;
+	}
+	unlock ();
+}
+
+void PathCache::lock () noexcept
+{
+	if (lock_.test_and_set (std::memory_order_acquire)) {
+		BackOff bo;
+		do {
+			bo ();
+		} while (lock_.test_and_set (std::memory_order_acquire));
+	}
+}
+
+}
+}
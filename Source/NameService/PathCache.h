@@ -0,0 +1,131 @@
+/// \file
+/*
+* Nirvana Core.
+*
+* This is a part of the Nirvana project.
+*
+* Author: Igor Popov
+*
+* Copyright (c) 2025 Igor Popov.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*
+* Send comments and/or bug reports to:
+*  popov.nirvana@gmail.com
+*/
+#ifndef NIRVANA_FS_CORE_PATHCACHE_H_
+#define NIRVANA_FS_CORE_PATHCACHE_H_
+#pragma once
+
+#include <Nirvana/Nirvana.h>
+#include <Nirvana/File.h>
+#include <Nirvana/Hash.h>
+#include <CORBA/CosNaming.h>
+#include "../MapUnorderedUnstable.h"
+#include "../SharedAllocator.h"
+#include <atomic>
+#include <vector>
+
+namespace Nirvana {
+namespace Core {
+
+/// Bounded cache of the file system path resolution results.
+///
+/// Maps the directory id and relative name to the item id and binding type.
+/// Negative entries remember the names that were not found.
+/// The cache is cleared on any name space modification, entries also expire after
+/// a short period because the host file system can be changed outside.
+class PathCache
+{
+public:
+	/// Maximal number of entries.
+	static const size_t MAX_ENTRIES = 1024;
+
+	PathCache () :
+		generation_ (0)
+	{}
+
+	typedef SharedString Key;
+
+	/// Make the cache key.
+	///
+	/// \param dir Directory id.
+	/// \param n Name relative to the directory.
+	/// \param [out] key The key.
+	static void make_key (const DirItemId& dir, const CosNaming::Name& n, Key& key);
+
+	/// Find entry.
+	///
+	/// \param key The key.
+	/// \param [out] id Item id.
+	/// \param [out] type Item binding type.
+	/// \param [out] missing Number of the not found trailing name components.
+	///                      Not zero if the entry is negative.
+	/// \param [out] generation Cache generation to pass to insert () on miss.
+	/// \returns `true` on hit.
+	bool find (const Key& key, DirItemId& id, CosNaming::BindingType& type, size_t& missing,
+		unsigned& generation);
+
+	/// Insert entry, if the cache was not modified since find ().
+	///
+	/// \param key The key.
+	/// \param id Item id.
+	/// \param type Item binding type.
+	/// \param missing Number of the not found trailing name components for negative entry.
+	/// \param generation The generation returned by find ().
+	void insert (Key&& key, const DirItemId& id, CosNaming::BindingType type, size_t missing,
+		unsigned generation);
+
+	/// Clear cache on the name space modification.
+	void clear () noexcept;
+
+	/// Remove negative entries on the item creation.
+	void clear_negative () noexcept;
+
+private:
+	void lock () noexcept;
+
+	void unlock () noexcept
+	{
+		lock_.clear (std::memory_order_release);
+	}
+
+	struct Entry
+	{
+		std::vector <CORBA::Octet, SharedAllocator <CORBA::Octet> > id;
+		DeadlineTime expire;
+		size_t missing;
+		CosNaming::BindingType type;
+	};
+
+	struct KeyHash
+	{
+		size_t operator () (const Key& key) const noexcept
+		{
+			return Nirvana::Hash::hash_bytes (key.data (), key.size ());
+		}
+	};
+
+	typedef MapUnorderedUnstable <Key, Entry, KeyHash, std::equal_to <Key>,
+		SharedAllocator> Map;
+
+	Map map_;
+	unsigned generation_;
+	std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+};
+
+}
+}
+
+#endif
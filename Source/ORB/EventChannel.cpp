@@ -34,6 +34,7 @@ void EventChannelBase::destroy (PortableServer::ServantBase::_ptr_type servant,
 {
 	check_exist ();
 	destroyed_ = true;
+	on_queue_room ();
 
 	deactivate_servant (servant, adapter);
 
@@ -69,6 +70,7 @@ void EventChannelBase::PullSupplierBase::disconnect_pull_supplier () noexcept
 			} catch (...) {}
 		}
 		event_.signal ();
+		channel_->on_queue_room ();
 	}
 }
 
@@ -104,9 +106,30 @@ void EventChannelBase::Children::destroy (PortableServer::POA::_ptr_type adapter
 	clear ();
 }
 
+bool EventChannelBase::wait_queue_room ()
+{
+	// The supplier set may change while waiting, so rescan it after each wait.
+	for (;;) {
+		if (destroyed_)
+			return false;
+		bool blocked = false;
+		for (const auto p : pull_suppliers_) {
+			if (static_cast <PullSupplierBase&> (*p).blocked ()) {
+				blocked = true;
+				break;
+			}
+		}
+		if (!blocked)
+			return true;
+		queue_room_.wait ();
+	}
+}
+
 void EventChannelBase::push (const Any& data)
 {
 	if (pull_suppliers_.connected ()) {
+		if (!wait_queue_room ())
+			return;
 		servant_reference <SharedAny> sany (make_reference <SharedAny> (std::ref (data)));
 		for (const auto p : pull_suppliers_) {
 			PullSupplierBase& sup = static_cast <PullSupplierBase&> (*p);
@@ -124,6 +147,19 @@ void EventChannelBase::push (const Any& data)
 	}
 }
 
+EventQueueStats EventChannelBase::queue_stats () const noexcept
+{
+	EventQueueStats stats;
+	for (const auto p : pull_suppliers_) {
+		const EventQueueStats& s = static_cast <const PullSupplierBase&> (*p).queue_stats ();
+		stats.depth += s.depth;
+		if (stats.max_depth < s.max_depth)
+			stats.max_depth = s.max_depth;
+		stats.dropped += s.dropped;
+	}
+	return stats;
+}
+
 void EventChannelBase::deactivate_servant (PortableServer::ServantBase::_ptr_type servant,
 	PortableServer::POA::_ptr_type adapter) noexcept
 {
@@ -31,7 +31,7 @@
 #include "../EventSync.h"
 #include "../MapUnorderedUnstable.h"
 #include "../UserAllocator.h"
-#include <queue>
+#include "EventQueue.h"
 
 #if defined (__GNUG__) || defined (__clang__)
 #pragma GCC diagnostic ignored "-Woverloaded-virtual"
@@ -40,11 +40,23 @@
 namespace CORBA {
 namespace Core {
 
-typedef Nirvana::Core::ImplDynamicSync <Any> SharedAny;
-
 class EventChannelBase
 {
 public:
+	/// Set the queue limit and overflow policy for the pull suppliers obtained after this call.
+	/// By default the queues are unlimited.
+	///
+	/// \param limit Maximal number of events in the queue, zero means unlimited.
+	/// \param policy Overflow policy.
+	void queue_limit (size_t limit, EventQueuePolicy policy) noexcept
+	{
+		queue_limit_ = limit;
+		queue_policy_ = policy;
+	}
+
+	/// Aggregated counters of the pull supplier queues.
+	EventQueueStats queue_stats () const noexcept;
+
 	void destroy (PortableServer::ServantBase::_ptr_type servant,
 		PortableServer::POA::_ptr_type adapter);
 
@@ -70,6 +82,8 @@ public:
 
 protected:
 	EventChannelBase () :
+		queue_limit_ (0),
+		queue_policy_ (EventQueuePolicy::DROP_OLDEST),
 		destroyed_ (false)
 	{}
 
@@ -284,6 +298,7 @@ protected:
 	public:
 		PullSupplierBase (EventChannelBase& channel) :
 			ChildObject (channel),
+			queue_ (channel.queue_limit_, channel.queue_policy_),
 			connected_ (false)
 		{}
 
@@ -329,12 +344,66 @@ protected:
 			return pull_internal ();
 		}
 
+		/// Pull up to \p how_many events in one call.
+		///
+		/// Waits for the first event, then returns all available events up to the limit.
+		///
+		/// \param how_many Maximal number of events.
+		/// \param [out] events Pulled events.
+		void pull_n (uint32_t how_many, IDL::Sequence <Any>& events)
+		{
+			if (!how_many)
+				throw BAD_PARAM ();
+			for (;;) {
+				if (!connected_)
+					throw CosEventComm::Disconnected ();
+				if (!queue_.empty ())
+					break;
+				event_.wait ();
+			}
+			try_pull_n (how_many, events);
+		}
+
+		/// Pull up to \p how_many available events without wait.
+		///
+		/// \param how_many Maximal number of events.
+		/// \param [out] events Pulled events.
+		/// \returns `false` if no events available.
+		bool try_pull_n (uint32_t how_many, IDL::Sequence <Any>& events)
+		{
+			if (!connected_)
+				throw CosEventComm::Disconnected ();
+			size_t cnt = std::min ((size_t)how_many, queue_.size ());
+			events.clear ();
+			events.reserve (cnt);
+			bool was_full = queue_.full ();
+			while (cnt--) {
+				events.push_back (*queue_.pop ());
+			}
+			if (was_full)
+				on_room ();
+			return !events.empty ();
+		}
+
+		/// Deliver event to the queue.
 		void push (SharedAny& data)
 		{
 			assert (connected_);
-			queue_.push (&data);
-			event_.signal ();
-			event_.reset ();
+			if (queue_.push (data)) {
+				event_.signal ();
+				event_.reset ();
+			}
+		}
+
+		/// \returns `true` if the channel push must wait for the queue room.
+		bool blocked () const noexcept
+		{
+			return connected_ && EventQueuePolicy::BLOCK == queue_.policy () && queue_.full ();
+		}
+
+		const EventQueueStats& queue_stats () const noexcept
+		{
+			return queue_.stats ();
 		}
 
 		bool connected () const noexcept
@@ -353,14 +422,22 @@ protected:
 	private:
 		Any pull_internal ()
 		{
-			servant_reference <SharedAny> ret (std::move (queue_.front ()));
-			queue_.pop ();
+			bool was_full = queue_.full ();
+			servant_reference <SharedAny> ret (queue_.pop ());
+			if (was_full)
+				on_room ();
 			return *ret;
 		}
 
+		void on_room () noexcept
+		{
+			if (channel_ && EventQueuePolicy::BLOCK == queue_.policy ())
+				channel_->on_queue_room ();
+		}
+
 	private:
 		CosEventComm::PullConsumer::_ref_type consumer_;
-		std::queue <servant_reference <SharedAny> > queue_;
+		EventQueue queue_;
 		Nirvana::Core::EventSync event_;
 		bool connected_;
 	};
@@ -606,6 +683,18 @@ protected:
 	Children pull_consumers_;
 
 private:
+	bool wait_queue_room ();
+
+	void on_queue_room () noexcept
+	{
+		queue_room_.signal ();
+		queue_room_.reset ();
+	}
+
+private:
+	Nirvana::Core::EventSync queue_room_;
+	size_t queue_limit_;
+	EventQueuePolicy queue_policy_;
 	bool destroyed_;
 };
 
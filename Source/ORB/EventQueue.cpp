@@ -0,0 +1,75 @@
+/*
+* Nirvana Core.
+*
+* This is a part of the Nirvana project.
+*
+* Author: Igor Popov
+*
+* Copyright (c) 2025 Igor Popov.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*
+* Send comments and/or bug reports to:
+*  popov.nirvana@gmail.com
+*/
+#include "../pch.h"
+#include "EventQueue.h"
+
+namespace CORBA {
+namespace Core {
+
+bool EventQueue::push (SharedAny& ev)
+{
+	if (full ()) {
+		assert (EventQueuePolicy::BLOCK != policy_);
+		++stats_.dropped;
+		if (EventQueuePolicy::DROP_OLDEST != policy_)
+			return false;
+		pop ();
+	}
+
+	if (size_ == buf_.size ())
+		grow ();
+
+	buf_ [(head_ + size_) & (buf_.size () - 1)] = &ev;
+	++size_;
+	stats_.depth = size_;
+	if (stats_.max_depth < size_)
+		stats_.max_depth = size_;
+	return true;
+}
+
+void EventQueue::grow ()
+{
+	size_t capacity = buf_.empty () ? 16 : buf_.size () * 2;
+	decltype (buf_) buf;
+	buf.reserve (capacity);
+	for (size_t i = 0; i < size_; ++i) {
+		buf.push_back (std::move (buf_ [(head_ + i) & (buf_.size () - 1)]));
+	}
+	buf.resize (capacity);
+	buf_.swap (buf);
+	head_ = 0;
+}
+
+void EventQueue::clear () noexcept
+{
+	buf_.clear ();
+	head_ = 0;
+	size_ = 0;
+	stats_.depth = 0;
+}
+
+}
+}
@@ -0,0 +1,140 @@
+/// \file
+/*
+* Nirvana Core.
+*
+* This is a part of the Nirvana project.
+*
+* Author: Igor Popov
+*
+* Copyright (c) 2025 Igor Popov.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*
+* Send comments and/or bug reports to:
+*  popov.nirvana@gmail.com
+*/
+#ifndef NIRVANA_ORB_CORE_EVENTQUEUE_H_
+#define NIRVANA_ORB_CORE_EVENTQUEUE_H_
+#pragma once
+
+#include <CORBA/CORBA.h>
+#include "../CoreInterface.h"
+#include "../UserAllocator.h"
+#include <vector>
+
+namespace CORBA {
+namespace Core {
+
+typedef Nirvana::Core::ImplDynamicSync <Any> SharedAny;
+
+/// Event queue overflow policy
+enum class EventQueuePolicy
+{
+	DROP_OLDEST, ///< Discard the oldest event in the queue
+	DROP_NEWEST, ///< Discard the incoming event
+	BLOCK        ///< Block the channel push until the queue has a room
+};
+
+/// Event queue counters
+struct EventQueueStats
+{
+	size_t depth;
+	size_t max_depth;
+	uint64_t dropped;
+
+	EventQueueStats () :
+		depth (0),
+		max_depth (0),
+		dropped (0)
+	{}
+};
+
+/// Bounded ring buffer of the shared events.
+///
+/// The buffer grows by power of 2 up to the limit.
+class EventQueue
+{
+public:
+	/// \param limit Maximal number of events in the queue, zero means unlimited.
+	/// \param policy Overflow policy.
+	EventQueue (size_t limit, EventQueuePolicy policy) :
+		limit_ (limit),
+		policy_ (policy),
+		head_ (0),
+		size_ (0)
+	{}
+
+	bool empty () const noexcept
+	{
+		return !size_;
+	}
+
+	size_t size () const noexcept
+	{
+		return size_;
+	}
+
+	bool full () const noexcept
+	{
+		return limit_ && size_ >= limit_;
+	}
+
+	EventQueuePolicy policy () const noexcept
+	{
+		return policy_;
+	}
+
+	/// Add event to the queue tail.
+	///
+	/// If the queue is full, the event is dropped according to the policy.
+	/// For the BLOCK policy the caller must wait for room before push.
+	///
+	/// \returns `false` if the incoming event was dropped.
+	bool push (SharedAny& ev);
+
+	/// Remove event from the queue head.
+	servant_reference <SharedAny> pop () noexcept
+	{
+		assert (size_);
+		servant_reference <SharedAny> ret (std::move (buf_ [head_]));
+		head_ = (head_ + 1) & (buf_.size () - 1);
+		--size_;
+		stats_.depth = size_;
+		return ret;
+	}
+
+	void clear () noexcept;
+
+	const EventQueueStats& stats () const noexcept
+	{
+		return stats_;
+	}
+
+private:
+	void grow ();
+
+private:
+	std::vector <servant_reference <SharedAny>,
+		Nirvana::Core::UserAllocator <servant_reference <SharedAny> > > buf_;
+	const size_t limit_;
+	const EventQueuePolicy policy_;
+	size_t head_;
+	size_t size_;
+	EventQueueStats stats_;
+};
+
+}
+}
+
+#endif
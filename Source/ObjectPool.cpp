@@ -26,6 +26,7 @@
 */
 #include "pch.h"
 #include "ObjectPool.h"
+#include <algorithm>
 
 namespace Nirvana {
 namespace Core {
@@ -33,24 +34,87 @@ namespace Core {
 ObjectPoolBase* ObjectPoolBase::pool_list_;
 ObjectPoolBase::Timer* ObjectPoolBase::timer_;
 
-ObjectPoolBase::ObjectPoolBase (unsigned min_size) noexcept :
+ObjectPoolBase::ObjectPoolBase (unsigned min_size, const char* name) noexcept :
 	next_ (pool_list_),
+	name_ (name),
+	cur_size_ (0),
 	min_size_ (min_size),
-	shrink_ ATOMIC_FLAG_INIT
+	active_ (0),
+	window_peak_ (0),
+	peaks_ {0},
+	window_idx_ (0),
+	target_ (min_size),
+	hits_ (0),
+	misses_ (0),
+	prewarmed_ (0),
+	destroyed_ (0)
 {
 	pool_list_ = this;
 }
 
-void ObjectPoolBase::on_pop () noexcept
+void ObjectPoolBase::housekeeping () noexcept
 {
-	if (cur_size_.decrement_seq () <= min_size_)
-		shrink_.clear ();
+	// Close the current period. The next one starts from the current usage.
+	size_t active = active_.load (std::memory_order_relaxed);
+	peaks_ [window_idx_] = window_peak_.exchange (active, std::memory_order_relaxed);
+	window_idx_ = (window_idx_ + 1) % PEAK_WINDOWS;
+
+	// Expect the usage peak of the recent periods to repeat
+	size_t peak = 0;
+	for (size_t p : peaks_) {
+		if (peak < p)
+			peak = p;
+	}
+	size_t target = peak > active ? peak - active : 0;
+	if (target < min_size_)
+		target = min_size_;
+	target_ = target;
+
+	size_t idle = cur_size_.load ();
+	if (idle < target) {
+		// Create objects in advance to avoid creation on the request path
+		unsigned cnt = (unsigned)std::min (target - idle, (size_t)PREWARM_MAX);
+		for (; cnt; --cnt) {
+			if (!grow_one ())
+				break;
+			++prewarmed_;
+		}
+	} else {
+		// Hysteresis: don't shrink if the excess is small
+		size_t high = target + target / 4 + 1;
+		if (idle > high) {
+			size_t cnt = (idle - target + 1) / 2;
+			for (; cnt; --cnt) {
+				if (!shrink_one ())
+					break;
+				destroyed_.fetch_add (1, std::memory_order_relaxed);
+			}
+		}
+	}
+}
+
+size_t ObjectPoolBase::stats (ObjectPoolStats* buf, size_t cnt) noexcept
+{
+	size_t pool_cnt = 0;
+	for (const ObjectPoolBase* p = pool_list_; p; p = p->next_, ++pool_cnt) {
+		if (pool_cnt < cnt) {
+			ObjectPoolStats& st = buf [pool_cnt];
+			st.name = p->name_;
+			st.hits = p->hits_.load (std::memory_order_relaxed);
+			st.misses = p->misses_.load (std::memory_order_relaxed);
+			st.prewarmed = p->prewarmed_;
+			st.destroyed = p->destroyed_.load (std::memory_order_relaxed);
+			st.idle = p->cur_size_.load ();
+			st.target = p->target_;
+		}
+	}
+	return pool_cnt;
 }
 
 void ObjectPoolBase::Timer::run (const TimeBase::TimeT&) noexcept
 {
 	for (ObjectPoolBase* p = pool_list_; p; p = p->next_) {
-		p->shrink ();
+		p->housekeeping ();
 	}
 }
 
@@ -50,6 +50,17 @@ public:
 		return Ref <Object>::template create <Object> ();
 	}
 
+	/// Create object to put it into the pool in advance.
+	///
+	/// Objects in the pool have zero reference count.
+	/// The object class must befriend the creator.
+	static Object* create_idle ()
+	{
+		Object* obj = new Object ();
+		obj->ref_cnt_.decrement ();
+		return obj;
+	}
+
 	static void release (Object* obj) noexcept
 	{
 		delete obj;
@@ -67,15 +78,45 @@ public:
 		return new Object ();
 	}
 
+	static Object* create_idle ()
+	{
+		return new Object ();
+	}
+
 	static void release (Object* obj) noexcept
 	{
 		delete obj;
 	}
 };
 
+/// Object pool counters
+struct ObjectPoolStats
+{
+	const char* name;
+	uint64_t hits;      ///< Objects got from the pool
+	uint64_t misses;    ///< Objects created because the pool was empty
+	uint64_t prewarmed; ///< Objects created in advance
+	uint64_t destroyed; ///< Objects deleted on shrink
+	size_t idle;        ///< Current number of objects in the pool
+	size_t target;      ///< Current target number of idle objects
+};
+
 class NIRVANA_NOVTABLE ObjectPoolBase
 {
 public:
+	/// Number of the housekeeping periods to track the peak usage.
+	static const unsigned PEAK_WINDOWS = 8;
+
+	/// Maximal number of objects created in advance per housekeeping period.
+	static const unsigned PREWARM_MAX = 16;
+
+	/// Get counters for all pools.
+	///
+	/// \param [out] buf Buffer for counters.
+	/// \param cnt Buffer size.
+	/// \returns Number of the pools.
+	static size_t stats (ObjectPoolStats* buf, size_t cnt) noexcept;
+
 	static void housekeeping_start ()
 	{
 		if (pool_list_) {
@@ -91,25 +132,55 @@ public:
 	}
 
 protected:
-	ObjectPoolBase (unsigned min_size) noexcept;
+	ObjectPoolBase (unsigned min_size, const char* name) noexcept;
+
+	/// Delete one object from the pool.
+	/// \returns `false` if the pool is empty.
+	virtual bool shrink_one () noexcept = 0;
 
-	virtual void shrink () noexcept = 0;
+	/// Create one object in the pool.
+	/// \returns `false` on failure.
+	virtual bool grow_one () noexcept = 0;
 
 	void on_push () noexcept
 	{
 		cur_size_.increment ();
 	}
 
-	void on_pop () noexcept;
+	void on_pop () noexcept
+	{
+		cur_size_.decrement ();
+	}
+
+	void on_hit () noexcept
+	{
+		hits_.fetch_add (1, std::memory_order_relaxed);
+		on_acquire ();
+	}
 
-	bool need_shrink () noexcept
+	void on_miss () noexcept
 	{
-		if (cur_size_.load () > min_size_)
-			return shrink_.test_and_set ();
-		else
-			return false;
+		misses_.fetch_add (1, std::memory_order_relaxed);
+		on_acquire ();
 	}
 
+	void on_release () noexcept
+	{
+		active_.fetch_sub (1, std::memory_order_relaxed);
+	}
+
+private:
+	void on_acquire () noexcept
+	{
+		size_t active = active_.fetch_add (1, std::memory_order_relaxed) + 1;
+		size_t peak = window_peak_.load (std::memory_order_relaxed);
+		while (peak < active && !window_peak_.compare_exchange_weak (peak, active,
+			std::memory_order_relaxed))
+			;
+	}
+
+	void housekeeping () noexcept;
+
 private:
 	class Timer :
 		public TimerAsyncCall,
@@ -126,10 +197,26 @@ private:
 
 private:
 	ObjectPoolBase* next_;
+	const char* name_;
 
 	AtomicCounter <false> cur_size_;
 	unsigned min_size_;
-	std::atomic_flag shrink_;
+
+	// Objects got from the pool and not released yet
+	std::atomic <size_t> active_;
+
+	// Peak of active_ in the current housekeeping period
+	std::atomic <size_t> window_peak_;
+
+	// Peaks of the previous periods
+	size_t peaks_ [PEAK_WINDOWS];
+	unsigned window_idx_;
+	size_t target_;
+
+	std::atomic <uint64_t> hits_;
+	std::atomic <uint64_t> misses_;
+	uint64_t prewarmed_;
+	std::atomic <uint64_t> destroyed_;
 
 	static ObjectPoolBase* pool_list_;
 	static Timer* timer_;
@@ -158,9 +245,10 @@ public:
 
 	/// Constructor.
 	/// 
-	/// \param housekeeping_interval Housekeeping interval.
-	ObjectPool (unsigned min_size) :
-		ObjectPoolBase (min_size)
+	/// \param min_size Minimal number of idle objects.
+	/// \param name Pool name for statistics.
+	ObjectPool (unsigned min_size, const char* name) :
+		ObjectPoolBase (min_size, name)
 	{}
 
 	/// Destructor.
@@ -182,8 +270,11 @@ public:
 		if (obj) {
 			ret = obj;
 			on_pop ();
-		} else
+			on_hit ();
+		} else {
 			ret = Creator::create ();
+			on_miss ();
+		}
 
 		assert ((((uintptr_t)&*ret) & Stack::Ptr::ALIGN_MASK) == 0);
 		return ret;
@@ -196,16 +287,31 @@ public:
 	{
 		Stack::push (*obj);
 		on_push ();
+		on_release ();
 	}
 
 private:
-	void shrink () noexcept override
+	bool shrink_one () noexcept override
+	{
+		Object* obj = Stack::pop ();
+		if (!obj)
+			return false;
+		on_pop ();
+		Creator::release (obj);
+		return true;
+	}
+
+	bool grow_one () noexcept override
 	{
-		if (need_shrink ()) {
-			Object* obj = Stack::pop ();
-			if (obj)
-				Creator::release (obj);
+		Object* obj;
+		try {
+			obj = Creator::create_idle ();
+		} catch (...) {
+			return false;
 		}
+		Stack::push (*obj);
+		on_push ();
+		return true;
 	}
 
 };
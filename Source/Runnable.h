@@ -44,6 +44,14 @@ public:
 	virtual void on_crash (const siginfo& signal) noexcept;
 };
 
+/// Short run-to-completion task.
+///
+/// The task must not suspend, must not call other synchronization contexts and must not
+/// throw exceptions. ExecDomain::async_call () executes such tasks on the worker thread stack
+/// without switching to the execution domain fiber.
+class NIRVANA_NOVTABLE RunnableShort : public Runnable
+{};
+
 }
 }
 
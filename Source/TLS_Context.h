@@ -40,10 +40,19 @@ namespace Core {
 class TLS_Context
 {
 public:
+	/// Number of the first TLS indexes stored inline.
+	/// TLS indexes are allocated from the lowest, so the most used indexes are here.
+	static const unsigned INLINE_COUNT = 8;
+
 	void set_value (unsigned idx, void* p, Deleter deleter)
 	{
 		if (!p)
 			deleter = nullptr;
+		if (idx < INLINE_COUNT) {
+			inline_ [idx] = Entry (p, deleter);
+			return;
+		}
+		idx -= INLINE_COUNT;
 		if (entries_.size () <= idx) {
 			if (!p)
 				return;
@@ -54,8 +63,12 @@ public:
 
 	void* get_value (unsigned idx) const noexcept
 	{
+		if (idx < INLINE_COUNT)
+			return inline_ [idx].ptr ();
+
 		// Do not check that index is really allocated, just return nullptr.
 		// It is for performance.
+		idx -= INLINE_COUNT;
 		if (entries_.size () <= idx)
 			return nullptr;
 		else
@@ -116,6 +129,9 @@ public:
 	};
 
 	typedef std::vector <Entry, UserAllocator <Entry> > Entries;
+
+private:
+	Entry inline_ [INLINE_COUNT];
 	Entries entries_;
 };
 
@@ -51,7 +51,7 @@ class ThreadBackground :
 public:
 	static void initialize ()
 	{
-		Creator::initialize (BACKGROUND_THREAD_POOL_MIN);
+		Creator::initialize (BACKGROUND_THREAD_POOL_MIN, "ThreadBackground");
 	}
 
 	static void terminate () noexcept
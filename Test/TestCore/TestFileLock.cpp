@@ -25,6 +25,8 @@
 */
 #include "pch.h"
 #include "../Source/FileLockRanges.h"
+#include <chrono>
+#include <iostream>
 
 using Nirvana::Core::FileLockRanges;
 using Nirvana::LockType;
@@ -225,4 +227,92 @@ TEST_F (TestFileLock, Merge)
 	}
 }
 
+TEST_F (TestFileLock, Split)
+{
+	FileLockRanges ranges;
+
+	EXPECT_TRUE (ranges.unchecked_set (5, 8, owner (1), LockType::LOCK_SHARED));
+	EXPECT_TRUE (ranges.unchecked_set (6, 7, owner (1), LockType::LOCK_EXCLUSIVE));
+	std::vector <FileLock> locks = ranges.get_all (owner (1));
+	ASSERT_EQ (locks.size (), 3);
+	EXPECT_EQ (locks [0].start (), 5);
+	EXPECT_EQ (locks [0].len (), 1);
+	EXPECT_EQ (locks [0].type (), LockType::LOCK_SHARED);
+	EXPECT_EQ (locks [1].start (), 6);
+	EXPECT_EQ (locks [1].len (), 1);
+	EXPECT_EQ (locks [1].type (), LockType::LOCK_EXCLUSIVE);
+	EXPECT_EQ (locks [2].start (), 7);
+	EXPECT_EQ (locks [2].len (), 1);
+	EXPECT_EQ (locks [2].type (), LockType::LOCK_SHARED);
+
+	EXPECT_TRUE (ranges.unchecked_set (6, 7, owner (1), LockType::LOCK_SHARED));
+	locks = ranges.get_all (owner (1));
+	ASSERT_EQ (locks.size (), 1);
+	EXPECT_EQ (locks.front ().start (), 5);
+	EXPECT_EQ (locks.front ().len (), 3);
+
+	// Partially locked range must be locked entirely
+	EXPECT_EQ (ranges.set (2, 8, LockType::LOCK_SHARED, LockType::LOCK_SHARED, owner (1)),
+		LockType::LOCK_SHARED);
+	locks = ranges.get_all (owner (1));
+	ASSERT_EQ (locks.size (), 1);
+	EXPECT_EQ (locks.front ().start (), 2);
+	EXPECT_EQ (locks.front ().len (), 6);
+}
+
+TEST_F (TestFileLock, DeleteAll)
+{
+	FileLockRanges ranges;
+
+	for (uintptr_t i = 0; i < 10; ++i) {
+		EXPECT_EQ (ranges.set (i * 10, i * 10 + 5, LockType::LOCK_SHARED, LockType::LOCK_SHARED,
+			owner (i % 2 + 1)), LockType::LOCK_SHARED);
+	}
+	EXPECT_EQ (ranges.get_all (owner (1)).size (), 5);
+	EXPECT_EQ (ranges.get_all (owner (2)).size (), 5);
+
+	EXPECT_TRUE (ranges.delete_all (owner (1)));
+	EXPECT_FALSE (ranges.delete_all (owner (1)));
+	EXPECT_TRUE (ranges.get_all (owner (1)).empty ());
+	EXPECT_EQ (ranges.get_all (owner (2)).size (), 5);
+	EXPECT_TRUE (ranges.check_write (0, 10, owner (3)));
+	EXPECT_FALSE (ranges.check_write (10, 20, owner (3)));
+}
+
+TEST_F (TestFileLock, Scaling)
+{
+	static const uintptr_t OWNER_CNT = 64;
+	static const Nirvana::FileSize STEP = 16;
+
+	for (size_t count = 1000; count <= 100000; count *= 10) {
+		FileLockRanges ranges;
+
+		auto t0 = std::chrono::steady_clock::now ();
+		for (size_t i = 0; i < count; ++i) {
+			Nirvana::FileSize begin = i * STEP;
+			ASSERT_EQ (ranges.set (begin, begin + STEP / 2, LockType::LOCK_SHARED, LockType::LOCK_SHARED,
+				owner (i % OWNER_CNT + 1)), LockType::LOCK_SHARED);
+		}
+		auto t1 = std::chrono::steady_clock::now ();
+		for (size_t i = 0; i < count; ++i) {
+			Nirvana::FileSize begin = i * STEP;
+			ASSERT_TRUE (ranges.check_read (begin, begin + STEP, owner (0)));
+			ASSERT_FALSE (ranges.check_write (begin, begin + 1, owner (0)));
+			ASSERT_TRUE (ranges.check_write (begin + STEP / 2, begin + STEP, owner (0)));
+		}
+		auto t2 = std::chrono::steady_clock::now ();
+		for (uintptr_t i = 1; i <= OWNER_CNT; ++i) {
+			ASSERT_TRUE (ranges.delete_all (owner (i)));
+		}
+		auto t3 = std::chrono::steady_clock::now ();
+		EXPECT_TRUE (ranges.check_write (0, FILE_SIZE_MAX, owner (0)));
+
+		std::cout << count << " locks: set "
+			<< std::chrono::duration_cast <std::chrono::microseconds> (t1 - t0).count ()
+			<< " us, check " << std::chrono::duration_cast <std::chrono::microseconds> (t2 - t1).count ()
+			<< " us, delete " << std::chrono::duration_cast <std::chrono::microseconds> (t3 - t2).count ()
+			<< " us\n";
+	}
+}
+
 }
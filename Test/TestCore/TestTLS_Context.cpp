@@ -0,0 +1,151 @@
+/*
+* Nirvana Core test.
+*
+* This is a part of the Nirvana project.
+*
+* Author: Igor Popov
+*
+* Copyright (c) 2025 Igor Popov.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*
+* Send comments and/or bug reports to:
+*  popov.nirvana@gmail.com
+*/
+#include "pch.h"
+#include "../Source/TLS_Context.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using Nirvana::Core::TLS_Context;
+
+namespace TestTLS_Context {
+
+class TestTLS_Context :
+	public ::testing::Test
+{
+protected:
+	TestTLS_Context ()
+	{}
+
+	virtual ~TestTLS_Context ()
+	{}
+
+	// If the constructor and destructor are not enough for setting up
+	// and cleaning up each test, you can define the following methods:
+
+	virtual void SetUp ()
+	{
+		// Code here will be called immediately after the constructor (right
+		// before each test).
+	}
+
+	virtual void TearDown ()
+	{
+		// Code here will be called immediately after each test (right
+		// before the destructor).
+	}
+};
+
+static unsigned deleted;
+
+static void deleter (void*)
+{
+	++deleted;
+}
+
+TEST_F (TestTLS_Context, Inline)
+{
+	deleted = 0;
+	int values [TLS_Context::INLINE_COUNT];
+	{
+		TLS_Context ctx;
+		for (unsigned i = 0; i < TLS_Context::INLINE_COUNT; ++i) {
+			EXPECT_FALSE (ctx.get_value (i));
+			ctx.set_value (i, values + i, deleter);
+			EXPECT_EQ (ctx.get_value (i), values + i);
+		}
+
+		ctx.set_value (0, nullptr, deleter);
+		EXPECT_FALSE (ctx.get_value (0));
+		EXPECT_EQ (deleted, 1u);
+
+		// Unset index above the inline range doesn't allocate
+		ctx.set_value (TLS_Context::INLINE_COUNT, nullptr, deleter);
+		EXPECT_FALSE (ctx.get_value (TLS_Context::INLINE_COUNT));
+		EXPECT_FALSE (ctx.get_value (TLS_Context::INLINE_COUNT * 4));
+	}
+	EXPECT_EQ (deleted, TLS_Context::INLINE_COUNT);
+}
+
+// The former implementation: all entries in the vector.
+class VectorContext
+{
+public:
+	void set_value (unsigned idx, void* p)
+	{
+		if (entries_.size () <= idx)
+			entries_.resize (idx + 1);
+		entries_ [idx] = p;
+	}
+
+	void* get_value (unsigned idx) const noexcept
+	{
+		if (entries_.size () <= idx)
+			return nullptr;
+		else
+			return entries_ [idx];
+	}
+
+private:
+	std::vector <void*> entries_;
+};
+
+TEST_F (TestTLS_Context, Benchmark)
+{
+	static const unsigned ITERATIONS = 10000000;
+	static const unsigned INDEXES = TLS_Context::INLINE_COUNT;
+
+	int values [INDEXES];
+	TLS_Context ctx;
+	VectorContext vctx;
+	for (unsigned i = 0; i < INDEXES; ++i) {
+		ctx.set_value (i, values + i, nullptr);
+		vctx.set_value (i, values + i);
+	}
+
+	// Volatile pointers prevent hoisting the loads out of the loops
+	const TLS_Context* volatile pctx = &ctx;
+	const VectorContext* volatile pvctx = &vctx;
+	uintptr_t sum = 0;
+
+	auto t0 = std::chrono::steady_clock::now ();
+	for (unsigned i = 0; i < ITERATIONS; ++i) {
+		sum += (uintptr_t)pvctx->get_value (i % INDEXES);
+	}
+	auto t1 = std::chrono::steady_clock::now ();
+	for (unsigned i = 0; i < ITERATIONS; ++i) {
+		sum -= (uintptr_t)pctx->get_value (i % INDEXES);
+	}
+	auto t2 = std::chrono::steady_clock::now ();
+	EXPECT_EQ (sum, 0u);
+
+	std::cout << ITERATIONS << " get_value: vector "
+		<< std::chrono::duration_cast <std::chrono::microseconds> (t1 - t0).count ()
+		<< " us, inline " << std::chrono::duration_cast <std::chrono::microseconds> (t2 - t1).count ()
+		<< " us\n";
+}
+
+}
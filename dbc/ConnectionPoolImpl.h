@@ -29,13 +29,44 @@
 
 #include "PoolableConnection.h"
 #include <Nirvana/System.h>
+#include <Nirvana/POSIX.h>
 
 namespace NDBC {
 
+/// Connection pool counters
+struct ConnectionPoolStats
+{
+	/// Number of getConnection () calls
+	uint64_t requests;
+
+	/// Total getConnection () time
+	TimeBase::TimeT wait_total;
+
+	/// Maximal getConnection () time
+	TimeBase::TimeT wait_max;
+
+	/// Connections closed by idle timeout or lifetime
+	uint64_t evicted;
+
+	/// Connections failed the validation on checkout
+	uint64_t validation_failed;
+
+	ConnectionPoolStats () :
+		requests (0),
+		wait_total (0),
+		wait_max (0),
+		evicted (0),
+		validation_failed (0)
+	{}
+};
+
 class ConnectionPoolImpl :
 	public CORBA::servant_traits <ConnectionPool>::Servant <ConnectionPoolImpl>
 {
 public:
+	/// Default validationInterval ()
+	static const TimeBase::TimeT DEFAULT_VALIDATION_INTERVAL = TimeBase::SECOND;
+
 	ConnectionPoolImpl (Driver::_ptr_type driver, IDL::String&& url, IDL::String&& user,
 		IDL::String&& password, uint32_t max_size, uint32_t max_create, uint16_t options) :
 		driver_ (std::move (driver)),
@@ -48,6 +79,13 @@ public:
 		cur_created_ (0),
 		may_create_ (Nirvana::the_system->create_event (false, max_create > 1)),
 		creation_timeout_ (std::numeric_limits <TimeBase::TimeT>::max ()),
+		min_idle_ (0),
+		idle_timeout_ (0),
+		max_lifetime_ (0),
+		validation_interval_ (DEFAULT_VALIDATION_INTERVAL),
+		statement_cache_max_count_ (StatementCache::DEFAULT_MAX_COUNT),
+		statement_cache_max_bytes_ (StatementCache::DEFAULT_MAX_BYTES),
+		normalize_sql_ (false),
 		options_ (options)
 	{
 		if (max_create == 0 || max_create < max_size)
@@ -65,14 +103,25 @@ public:
 
 	Connection::_ref_type getConnection ()
 	{
+		Nirvana::SteadyTime start = Nirvana::the_posix->steady_clock ();
 		CORBA::servant_reference <PoolableConnection> conn;
-		if (!connections_.empty ()) {
-			conn = CORBA::make_reference <PoolableConnection> (std::ref (*this),
-				std::move (connections_.top ()));
+		while (!connections_.empty ()) {
+			ConnectionData cd (std::move (connections_.top ()));
 			connections_.pop ();
 			--cur_size_;
-		} else {
+			if (check_out (cd, start)) {
+				conn = CORBA::make_reference <PoolableConnection> (std::ref (*this), std::move (cd));
+				break;
+			} else {
+				try {
+					cd->close ();
+				} catch (...) {
+				}
+				connection_destructed ();
+			}
+		}
 
+		if (!conn) {
 			for (;;) {
 				if (cur_created_ >= max_create_ && !may_create_->wait (creation_timeout_))
 					throw SQLException (SQLWarning (1, "Connection create timeout"), NDBC::SQLWarnings ());
@@ -80,9 +129,10 @@ public:
 
 				conn = CORBA::make_reference <PoolableConnection> (std::ref (*this),
 					ConnectionData (driver_->connect (url_, user_, password_)));
-				if (max_create_ == ++cur_created_)
+				if (max_create_ == ++cur_created_) {
 					may_create_->reset ();
-				else if (cur_created_ > max_create_) {
+					break;
+				} else if (cur_created_ > max_create_) {
 					conn->close ();
 					conn = nullptr;
 					if (max_create_ == --cur_created_)
@@ -91,6 +141,13 @@ public:
 					break;
 			}
 		}
+
+		TimeBase::TimeT wait = Nirvana::the_posix->steady_clock () - start;
+		++stats_.requests;
+		stats_.wait_total += wait;
+		if (stats_.wait_max < wait)
+			stats_.wait_max = wait;
+
 		return conn->_this ();
 	}
 
@@ -105,9 +162,70 @@ public:
 		while (cur_size_ > max_size_) {
 			--cur_size_;
 			connections_.pop ();
+			connection_destructed ();
 		}
 	}
 
+	/// Minimal number of the idle connections.
+	/// The pool is filled on the connection returns, one connection per return.
+	uint32_t minIdle () const noexcept
+	{
+		return min_idle_;
+	}
+
+	void minIdle (uint32_t n) noexcept
+	{
+		min_idle_ = n;
+	}
+
+	/// The idle connection is closed after this time. Zero means infinite.
+	TimeBase::TimeT idleTimeout () const noexcept
+	{
+		return idle_timeout_;
+	}
+
+	void idleTimeout (TimeBase::TimeT t) noexcept
+	{
+		idle_timeout_ = t;
+	}
+
+	/// The connection is closed after this time since creation. Zero means infinite.
+	TimeBase::TimeT maxLifetime () const noexcept
+	{
+		return max_lifetime_;
+	}
+
+	void maxLifetime (TimeBase::TimeT t) noexcept
+	{
+		max_lifetime_ = t;
+	}
+
+	/// The connection idle longer than this time is validated on checkout.
+	TimeBase::TimeT validationInterval () const noexcept
+	{
+		return validation_interval_;
+	}
+
+	void validationInterval (TimeBase::TimeT t) noexcept
+	{
+		validation_interval_ = t;
+	}
+
+	uint32_t idleCount () const noexcept
+	{
+		return cur_size_;
+	}
+
+	uint32_t activeCount () const noexcept
+	{
+		return cur_created_ - cur_size_;
+	}
+
+	const ConnectionPoolStats& stats () const noexcept
+	{
+		return stats_;
+	}
+
 	uint32_t maxCreate () const noexcept
 	{
 		return max_create_;
@@ -137,6 +255,56 @@ public:
 		return cur_created_;
 	}
 
+	/// Limit of the prepared statements cached per connection.
+	size_t statementCacheMaxCount () const noexcept
+	{
+		return statement_cache_max_count_;
+	}
+
+	void statementCacheMaxCount (size_t limit) noexcept
+	{
+		statement_cache_max_count_ = limit;
+	}
+
+	/// Limit of the SQL text bytes held by the prepared statements cached per connection.
+	size_t statementCacheMaxBytes () const noexcept
+	{
+		return statement_cache_max_bytes_;
+	}
+
+	void statementCacheMaxBytes (size_t limit) noexcept
+	{
+		statement_cache_max_bytes_ = limit;
+	}
+
+	/// If `true`, the statements which differ in literals only share the prepared statement.
+	bool normalizeSQL () const noexcept
+	{
+		return normalize_sql_;
+	}
+
+	void normalizeSQL (bool on) noexcept
+	{
+		normalize_sql_ = on;
+	}
+
+	/// Statement cache counters summed over all connections.
+	const StatementCacheStats& statementCacheStats () const noexcept
+	{
+		return statement_cache_stats_;
+	}
+
+	void statement_cache_hit () noexcept
+	{
+		++statement_cache_stats_.hits;
+	}
+
+	void statement_cache_miss (size_t evicted) noexcept
+	{
+		++statement_cache_stats_.misses;
+		statement_cache_stats_.evictions += evicted;
+	}
+
 	Pool <ConnectionData>& connections () noexcept
 	{
 		return connections_;
@@ -163,11 +331,74 @@ public:
 			may_create_->signal ();
 	}
 
+	/// Close expired idle connections and make one step to fill the pool up to minIdle ().
+	/// Called on each connection return, so at most one connect is added to the release.
+	void maintain () noexcept
+	{
+		Nirvana::SteadyTime now = Nirvana::the_posix->steady_clock ();
+		try {
+			size_t closed = connections_.close_if ([this, now](const ConnectionData& cd) {
+				return expired (cd, now);
+			});
+			stats_.evicted += closed;
+			while (closed--) {
+				--cur_size_;
+				connection_destructed ();
+			}
+		} catch (...) {
+		}
+
+		if (cur_size_ < min_idle_ && cur_size_ < max_size_ && cur_created_ < max_create_) {
+			try {
+				ConnectionData cd (driver_->connect (url_, user_, password_));
+				if (cur_created_ >= max_create_ || cur_size_ >= max_size_) {
+					// Other connections were created while we were waiting
+					cd->close ();
+					return;
+				}
+				connections_.push (std::move (cd));
+				++cur_size_;
+				if (max_create_ == ++cur_created_)
+					may_create_->reset ();
+			} catch (...) {
+			}
+		}
+	}
+
 	unsigned options () const noexcept
 	{
 		return options_;
 	}
 
+private:
+	bool expired (const ConnectionData& cd, Nirvana::SteadyTime now) const noexcept
+	{
+		return (max_lifetime_ && now - cd.created >= (Nirvana::SteadyTime)max_lifetime_)
+			|| (idle_timeout_ && now - cd.released >= (Nirvana::SteadyTime)idle_timeout_);
+	}
+
+	bool check_out (const ConnectionData& cd, Nirvana::SteadyTime now)
+	{
+		if (expired (cd, now)) {
+			++stats_.evicted;
+			return false;
+		}
+
+		if (now - cd.released >= (Nirvana::SteadyTime)validation_interval_) {
+			bool valid;
+			try {
+				valid = !cd->isClosed ();
+			} catch (...) {
+				valid = false;
+			}
+			if (!valid) {
+				++stats_.validation_failed;
+				return false;
+			}
+		}
+		return true;
+	}
+
 private:
 	Driver::_ref_type driver_;
 	IDL::String url_, user_, password_;
@@ -175,9 +406,70 @@ private:
 	uint32_t max_size_, cur_size_, max_create_, cur_created_;
 	Nirvana::Event::_ref_type may_create_;
 	TimeBase::TimeT creation_timeout_;
+	uint32_t min_idle_;
+	TimeBase::TimeT idle_timeout_;
+	TimeBase::TimeT max_lifetime_;
+	TimeBase::TimeT validation_interval_;
+	ConnectionPoolStats stats_;
+	size_t statement_cache_max_count_;
+	size_t statement_cache_max_bytes_;
+	bool normalize_sql_;
+	StatementCacheStats statement_cache_stats_;
 	const unsigned options_;
 };
 
+inline PreparedStatement::_ref_type PoolableConnection::prepareStatement (const IDL::String& sql,
+	ResultSet::Type resultSetType, unsigned flags)
+{
+	ConnectionData& d = data ();
+	Row literals;
+	IDL::String normalized;
+	bool normalize = parent_->normalizeSQL () && normalize_sql (sql, normalized, literals);
+	for (;;) {
+		const IDL::String& key = normalize ? normalized : sql;
+		StatementCache::Entry& entry = d.prepared_statements.get (key);
+		if (entry.normalize_failed) {
+			normalize = false;
+			literals.clear ();
+			continue;
+		}
+		RefPool <PreparedStatement>& pool = entry.types [(size_t)resultSetType];
+		PreparedStatement::_ref_type s;
+		if (!pool.empty ()) {
+			s = std::move (pool.top ());
+			pool.pop ();
+			d.prepared_statements.hit ();
+			parent_->statement_cache_hit ();
+		} else {
+			// Count the statement before preparation to pin the entry
+			size_t evicted;
+			try {
+				evicted = d.prepared_statements.miss (entry,
+					parent_->statementCacheMaxCount (), parent_->statementCacheMaxBytes ());
+				s = d->prepareStatement (key, resultSetType, PreparedStatement::PREPARE_PERSISTENT);
+			} catch (...) {
+				d.prepared_statements.cancel_miss (entry);
+				if (!normalize)
+					throw;
+				// The parameter marker may be not allowed in place of some literal.
+				// Prepare the original SQL.
+				entry.normalize_failed = true;
+				normalize = false;
+				literals.clear ();
+				continue;
+			}
+			parent_->statement_cache_miss (evicted);
+		}
+		CORBA::servant_reference <PoolablePreparedStatement> ps =
+			CORBA::make_reference <PoolablePreparedStatement> (std::ref (*this),
+				std::ref (d.prepared_statements), std::ref (*entry.sql), std::ref (pool),
+				std::move (s), std::move (literals));
+		if (normalize)
+			ps->bind_literals ();
+		return ps->_this ();
+	}
+}
+
 inline void PoolableConnection::cleanup (ConnectionData& data)
 {
 	if (parent_->options () & Manager::DO_NOT_SHARE_PREPARED)
@@ -198,6 +490,7 @@ inline void PoolableConnection::cleanup (ConnectionData& data)
 	}
 
 	data.reset ();
+	data.released = Nirvana::the_posix->steady_clock ();
 }
 
 inline void PoolableConnection::release_to_pool () noexcept
@@ -205,6 +498,7 @@ inline void PoolableConnection::release_to_pool () noexcept
 	if (parent_->release_to_pool ()) {
 		if (!Base::release_to_pool ())
 			parent_->release_failed ();
+		parent_->maintain ();
 	} else {
 		{
 			ConnectionData data (std::move (Base::data_));
@@ -31,6 +31,7 @@
 #include <CORBA/Server.h>
 #include <Nirvana/NDBC_s.h>
 #include <stack>
+#include <vector>
 
 namespace NDBC {
 
@@ -49,6 +50,12 @@ public:
 
 	void clear () noexcept;
 
+	/// Remove and close the elements that satisfy the predicate.
+	///
+	/// \returns Number of the closed elements.
+	template <class Pred>
+	size_t close_if (Pred pred);
+
 	Pool (const Pool&) = delete;
 	Pool (Pool&&) = default;
 
@@ -71,6 +78,29 @@ void Pool <Data>::clear () noexcept
 	}
 }
 
+template <class Data>
+template <class Pred>
+size_t Pool <Data>::close_if (Pred pred)
+{
+	// Close after the removal, because close () may suspend.
+	std::vector <Data> removed;
+	for (auto it = Base::c.begin (); it != Base::c.end ();) {
+		if (pred (*it)) {
+			removed.push_back (std::move (*it));
+			it = Base::c.erase (it);
+		} else
+			++it;
+	}
+	for (auto& data : removed) {
+		try {
+			data->close ();
+		} catch (...) {
+			// TODO: Log
+		}
+	}
+	return removed.size ();
+}
+
 class PoolableBase
 {
 public:
@@ -145,7 +175,7 @@ public:
 	bool close ()
 	{
 		if (Base::close ()) {
-			release_to_pool ();
+			static_cast <S&> (*this).release_to_pool ();
 			Base::deactivate (this);
 			return true;
 		}
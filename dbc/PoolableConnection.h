@@ -27,28 +27,17 @@
 #define NDBC_POOLABLECONNECTION_H_
 #pragma once
 
-#include "PoolableStatement.h"
-#include "../Source/MapUnorderedStable.h"
+#include "StatementCache.h"
 #include "../Source/MapUnorderedUnstable.h"
+#include <Nirvana/POSIX.h>
 
 namespace NDBC {
 
-template <class Itf>
-struct StatementPool
-{
-	RefPool <Itf> types [(size_t)ResultSet::Type::TYPE_SCROLL_SENSITIVE + 1];
-
-	void clear () noexcept
-	{
-		for (auto& pool : types) {
-			pool.clear ();
-		}
-	}
-};
-
 struct ConnectionData : public Connection::_ref_type
 {
-	ConnectionData ()
+	ConnectionData () :
+		created (0),
+		released (0)
 	{}
 
 	ConnectionData (Connection::_ref_type&& conn) :
@@ -56,7 +45,9 @@ struct ConnectionData : public Connection::_ref_type
 		catalog (p_->getCatalog ()),
 		schema (p_->getSchema ()),
 		ti (p_->getTransactionIsolation ()),
-		read_only (p_->isReadOnly ())
+		read_only (p_->isReadOnly ()),
+		created (Nirvana::the_posix->steady_clock ()),
+		released (created)
 	{}
 
 	void reset () const
@@ -74,10 +65,16 @@ struct ConnectionData : public Connection::_ref_type
 	ConnectionData& operator = (ConnectionData&&) = delete;
 
 	StatementPool <Statement> statements;
-	Nirvana::Core::MapUnorderedStable <std::string, StatementPool <PreparedStatement> > prepared_statements;
+	StatementCache prepared_statements;
 	IDL::String catalog, schema;
 	Connection::TransactionIsolation ti;
 	bool read_only;
+
+	/// Connection creation time
+	Nirvana::SteadyTime created;
+
+	/// Last time the connection was returned to the pool
+	Nirvana::SteadyTime released;
 };
 
 class ConnectionPoolImpl;
@@ -120,20 +117,7 @@ public:
 	}
 
 	PreparedStatement::_ref_type prepareStatement (const IDL::String& sql,
-		ResultSet::Type resultSetType, unsigned flags)
-	{
-		ConnectionData& d = data ();
-		RefPool <PreparedStatement>& pool = d.prepared_statements.emplace (sql,
-			StatementPool <PreparedStatement> ()).first->second.types [(size_t)resultSetType];
-		PreparedStatement::_ref_type s;
-		if (!pool.empty ()) {
-			s = std::move (pool.top ());
-			pool.pop ();
-		} else
-			s = d->prepareStatement (sql, resultSetType, PreparedStatement::PREPARE_PERSISTENT);
-		return CORBA::make_reference <PoolablePreparedStatement> (std::ref (*this), std::ref (pool),
-			std::move (s))->_this ();
-	}
+		ResultSet::Type resultSetType, unsigned flags);
 
 	SQLWarnings getWarnings ()
 	{
@@ -32,6 +32,7 @@
 namespace NDBC {
 
 class PoolableConnection;
+class StatementCache;
 
 class PoolableStatementBase
 {
@@ -171,11 +172,34 @@ class PoolablePreparedStatement : public PoolableStatementS <PreparedStatement,
 	using Base = PoolableStatementS <PreparedStatement, PoolablePreparedStatement>;
 
 public:
-	PoolablePreparedStatement (PoolableConnection& conn, PoolType& pool,
-		PreparedStatement::_ref_type&& impl) noexcept :
-		Base (conn, pool, std::move (impl))
+	PoolablePreparedStatement (PoolableConnection& conn, StatementCache& cache, const IDL::String& sql,
+		PoolType& pool, PreparedStatement::_ref_type&& impl, Row&& literals) noexcept :
+		Base (conn, pool, std::move (impl)),
+		cache_ (cache),
+		sql_ (sql),
+		literals_ (std::move (literals))
 	{}
 
+	/// Bind the literals extracted by the SQL normalization.
+	void bind_literals ()
+	{
+		PreparedStatement::_ptr_type s = data ();
+		Ordinal idx = 1;
+		for (const Variant& v : literals_) {
+			switch (v._d ()) {
+			case DB_BIGINT:
+				s->setBigInt (idx, v.ll_val ());
+				break;
+			case DB_DOUBLE:
+				s->setDouble (idx, v.dbl_val ());
+				break;
+			default:
+				s->setString (idx, v.s_val ());
+			}
+			++idx;
+		}
+	}
+
 	void setBigInt (Ordinal idx, int64_t v)
 	{
 		data ()->setBigInt (idx, v);
@@ -316,6 +340,7 @@ public:
 	void clearParameters ()
 	{
 		data ()->clearParameters ();
+		bind_literals ();
 	}
 
 	static void cleanup (PreparedStatement::_ref_type& s)
@@ -323,6 +348,13 @@ public:
 		s->clearParameters ();
 		Base::cleanup (s);
 	}
+
+	inline bool release_to_pool () noexcept;
+
+private:
+	StatementCache& cache_;
+	const IDL::String& sql_;
+	Row literals_;
 };
 
 }
@@ -0,0 +1,418 @@
+/*
+* Database connection module.
+*
+* This is a part of the Nirvana project.
+*
+* Author: Igor Popov
+*
+* Copyright (c) 2025 Igor Popov.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*
+* Send comments and/or bug reports to:
+*  popov.nirvana@gmail.com
+*/
+#include "pch.h"
+#include "StatementCache.h"
+#include <algorithm>
+#include <vector>
+#include <errno.h>
+#include <stdlib.h>
+
+namespace NDBC {
+
+StatementCache::Entry& StatementCache::get (const IDL::String& sql)
+{
+	auto ins = map_.emplace (std::piecewise_construct, std::forward_as_tuple (sql),
+		std::forward_as_tuple ());
+	Entry& entry = ins.first->second;
+	if (ins.second)
+		entry.sql = &ins.first->first;
+	else
+		unlink (entry);
+	push_front (entry);
+	return entry;
+}
+
+size_t StatementCache::miss (Entry& entry, size_t max_count, size_t max_bytes)
+{
+	++stats_.misses;
+	++entry.created;
+	++count_;
+	bytes_ += entry.sql->size ();
+
+	// Statements are closed after all evictions, because close () may suspend.
+	std::vector <StatementPool <PreparedStatement> > evicted;
+	for (Entry* victim = tail_; victim && (count_ > max_count || bytes_ > max_bytes);) {
+		Entry* prev = victim->prev;
+		if (victim != &entry && victim->idle ()) {
+			evicted.emplace_back (std::move (static_cast <StatementPool <PreparedStatement>&> (*victim)));
+			count_ -= victim->created;
+			bytes_ -= victim->created * victim->sql->size ();
+			unlink (*victim);
+			map_.erase (map_.find (*victim->sql));
+		}
+		victim = prev;
+	}
+	stats_.evictions += evicted.size ();
+	return evicted.size ();
+}
+
+void StatementCache::clear () noexcept
+{
+	map_.clear ();
+	head_ = tail_ = nullptr;
+	count_ = 0;
+	bytes_ = 0;
+}
+
+void StatementCache::unlink (Entry& entry) noexcept
+{
+	if (entry.prev)
+		entry.prev->next = entry.next;
+	else
+		head_ = entry.next;
+	if (entry.next)
+		entry.next->prev = entry.prev;
+	else
+		tail_ = entry.prev;
+	entry.prev = entry.next = nullptr;
+}
+
+void StatementCache::push_front (Entry& entry) noexcept
+{
+	entry.prev = nullptr;
+	entry.next = head_;
+	if (head_)
+		head_->prev = &entry;
+	else
+		tail_ = &entry;
+	head_ = &entry;
+}
+
+namespace {
+
+inline bool is_space (char c) noexcept
+{
+	return ' ' == c || '\t' == c || '\n' == c || '\r' == c || '\f' == c || '\v' == c;
+}
+
+inline bool is_digit (char c) noexcept
+{
+	return '0' <= c && c <= '9';
+}
+
+inline bool is_ident (char c) noexcept
+{
+	return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || is_digit (c) || '_' == c
+		|| (unsigned char)c >= 0x80;
+}
+
+bool equal_nocase (const char* begin, const char* end, const char* keyword) noexcept
+{
+	for (; begin != end; ++begin, ++keyword) {
+		char c = *begin;
+		if ('a' <= c && c <= 'z')
+			c -= 'a' - 'A';
+		if (c != *keyword)
+			return false;
+	}
+	return !*keyword;
+}
+
+bool is_select_list_end (const char* begin, const char* end) noexcept
+{
+	static const char* const keywords [] = {
+		"FROM", "WHERE", "GROUP", "ORDER", "HAVING", "WINDOW", "LIMIT", "UNION", "EXCEPT", "INTERSECT"
+	};
+	for (const char* kw : keywords) {
+		if (equal_nocase (begin, end, kw))
+			return true;
+	}
+	return false;
+}
+
+bool is_clause_end (const char* begin, const char* end) noexcept
+{
+	static const char* const keywords [] = {
+		"LIMIT", "OFFSET", "HAVING", "WINDOW", "UNION", "EXCEPT", "INTERSECT"
+	};
+	for (const char* kw : keywords) {
+		if (equal_nocase (begin, end, kw))
+			return true;
+	}
+	return false;
+}
+
+}
+
+bool normalize_sql (const IDL::String& sql, IDL::String& normalized, Row& literals)
+{
+	normalized.clear ();
+	literals.clear ();
+
+	const char* p = sql.data ();
+	const char* end = p + sql.size ();
+
+	// Only the data manipulation statements accept parameters in place of literals
+	while (p != end && is_space (*p))
+		++p;
+	const char* first = p;
+	while (p != end && is_ident (*p))
+		++p;
+	if (!(equal_nocase (first, p, "SELECT") || equal_nocase (first, p, "INSERT")
+		|| equal_nocase (first, p, "UPDATE") || equal_nocase (first, p, "DELETE")
+		|| equal_nocase (first, p, "REPLACE") || equal_nocase (first, p, "WITH")))
+		return false;
+
+	normalized.reserve (sql.size ());
+	normalized.assign (first, p);
+
+	// Numbers in ORDER BY and GROUP BY lists are the column indexes, keep them.
+	const char* prev_ident = nullptr;
+	const char* prev_ident_end = nullptr;
+	bool by_list = false;
+	bool space = false;
+
+	// Literals in the select list define the result column names, keep them.
+	// The vector contains the parentheses depths of the open select lists.
+	unsigned depth = 0;
+	std::vector <unsigned> select_lists;
+	if (equal_nocase (first, p, "SELECT"))
+		select_lists.push_back (0);
+
+	// Type name arguments, like in CAST (x AS DECIMAL (10, 2)), must be literals.
+	// after_as: 1 - AS keyword, 2 - AS followed by the type name.
+	unsigned after_as = 0;
+	bool type_args = false;
+	unsigned type_args_depth = 0;
+
+	while (p != end) {
+		char c = *p;
+
+		if (is_space (c)) {
+			space = true;
+			++p;
+			continue;
+		}
+
+		if ('-' == c && end - p > 1 && '-' == p [1]) {
+			while (p != end && '\n' != *p)
+				++p;
+			space = true;
+			continue;
+		}
+
+		if ('/' == c && end - p > 1 && '*' == p [1]) {
+			p += 2;
+			for (;;) {
+				if (end - p < 2) {
+					p = end;
+					break;
+				}
+				if ('*' == p [0] && '/' == p [1]) {
+					p += 2;
+					break;
+				}
+				++p;
+			}
+			space = true;
+			continue;
+		}
+
+		if (space && !normalized.empty ())
+			normalized += ' ';
+		space = false;
+
+		bool keep_literal = by_list || type_args || !select_lists.empty ();
+
+		if (!is_ident (c) && '(' != c)
+			after_as = 0;
+
+		switch (c) {
+		case '?':
+		case ':':
+		case '@':
+		case '$':
+			// Parameter marker
+			return false;
+
+		case '\'': {
+			const char* begin = p;
+			IDL::String s;
+			for (++p;;) {
+				if (p == end)
+					return false; // Unterminated
+				if ('\'' == *p) {
+					if (end - p > 1 && '\'' == p [1]) {
+						s += '\'';
+						p += 2;
+					} else {
+						++p;
+						break;
+					}
+				} else
+					s += *(p++);
+			}
+			if (keep_literal)
+				normalized.append (begin, p);
+			else {
+				literals.emplace_back ();
+				literals.back ().s_val (std::move (s));
+				normalized += '?';
+			}
+		} continue;
+
+		case '(':
+			if (2 == after_as && !type_args) {
+				type_args = true;
+				type_args_depth = depth;
+			}
+			after_as = 0;
+			++depth;
+			normalized += c;
+			++p;
+			continue;
+
+		case ')':
+			if (depth)
+				--depth;
+			if (type_args && type_args_depth == depth)
+				type_args = false;
+			while (!select_lists.empty () && select_lists.back () > depth)
+				select_lists.pop_back ();
+			normalized += c;
+			++p;
+			continue;
+
+		case '"':
+		case '`':
+		case '[': {
+			// Quoted identifier
+			char close = '[' == c ? ']' : c;
+			const char* begin = p++;
+			for (;;) {
+				if (p == end)
+					return false;
+				if (close == *(p++)) {
+					if ('[' != c && p != end && close == *p)
+						++p;
+					else
+						break;
+				}
+			}
+			normalized.append (begin, p);
+		} continue;
+		}
+
+		if (is_digit (c) || ('.' == c && end - p > 1 && is_digit (p [1]))) {
+			const char* begin = p;
+			bool real = false;
+			if ('0' == c && end - p > 1 && ('x' == p [1] || 'X' == p [1])) {
+				// Hexadecimal, keep as is
+				p += 2;
+				while (p != end && is_ident (*p))
+					++p;
+				normalized.append (begin, p);
+				continue;
+			}
+			while (p != end && is_digit (*p))
+				++p;
+			if (p != end && '.' == *p) {
+				real = true;
+				++p;
+				while (p != end && is_digit (*p))
+					++p;
+			}
+			if (p != end && ('e' == *p || 'E' == *p)) {
+				const char* exp = p + 1;
+				if (exp != end && ('+' == *exp || '-' == *exp))
+					++exp;
+				if (exp != end && is_digit (*exp)) {
+					real = true;
+					p = exp;
+					while (p != end && is_digit (*p))
+						++p;
+				}
+			}
+			if (keep_literal || (p != end && is_ident (*p))) {
+				while (p != end && is_ident (*p))
+					++p;
+				normalized.append (begin, p);
+				continue;
+			}
+
+			IDL::String num (begin, p);
+			literals.emplace_back ();
+			Variant& v = literals.back ();
+			if (!real) {
+				errno = 0;
+				long long ll = strtoll (num.c_str (), nullptr, 10);
+				if (ERANGE == errno)
+					real = true;
+				else
+					v.ll_val (ll);
+			}
+			if (real)
+				v.dbl_val (strtod (num.c_str (), nullptr));
+			normalized += '?';
+			continue;
+		}
+
+		if (is_ident (c)) {
+			const char* begin = p;
+			while (p != end && is_ident (*p))
+				++p;
+			if ((1 == p - begin) && ('x' == c || 'X' == c) && p != end && '\'' == *p) {
+				// Blob literal, keep as is
+				p = std::find (p + 1, end, '\'');
+				if (p == end)
+					return false;
+				++p;
+				normalized.append (begin, p);
+				continue;
+			}
+			if (equal_nocase (begin, p, "BY") && prev_ident
+				&& (equal_nocase (prev_ident, prev_ident_end, "ORDER")
+					|| equal_nocase (prev_ident, prev_ident_end, "GROUP")))
+				by_list = true;
+			else if (is_clause_end (begin, p))
+				by_list = false;
+
+			if (equal_nocase (begin, p, "SELECT"))
+				select_lists.push_back (depth);
+			else if (!select_lists.empty () && select_lists.back () == depth && is_select_list_end (begin, p))
+				select_lists.pop_back ();
+
+			if (equal_nocase (begin, p, "AS"))
+				after_as = 1;
+			else if (after_as && !equal_nocase (begin, p, "NOT") && !equal_nocase (begin, p, "MATERIALIZED"))
+				after_as = 2; // WITH t AS [NOT] MATERIALIZED (...) is not a type name
+			else
+				after_as = 0;
+
+			prev_ident = begin;
+			prev_ident_end = p;
+			normalized.append (begin, p);
+			continue;
+		}
+
+		normalized += c;
+		++p;
+	}
+
+	return true;
+}
+
+}
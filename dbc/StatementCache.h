@@ -0,0 +1,219 @@
+/*
+* Database connection module.
+*
+* This is a part of the Nirvana project.
+*
+* Author: Igor Popov
+*
+* Copyright (c) 2025 Igor Popov.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*
+* Send comments and/or bug reports to:
+*  popov.nirvana@gmail.com
+*/
+#ifndef NDBC_STATEMENTCACHE_H_
+#define NDBC_STATEMENTCACHE_H_
+#pragma once
+
+#include "PoolableStatement.h"
+#include "../Source/MapUnorderedStable.h"
+
+namespace NDBC {
+
+template <class Itf>
+struct StatementPool
+{
+	RefPool <Itf> types [(size_t)ResultSet::Type::TYPE_SCROLL_SENSITIVE + 1];
+
+	void clear () noexcept
+	{
+		for (auto& pool : types) {
+			pool.clear ();
+		}
+	}
+
+	size_t size () const noexcept
+	{
+		size_t cnt = 0;
+		for (const auto& pool : types) {
+			cnt += pool.size ();
+		}
+		return cnt;
+	}
+};
+
+/// Statement cache counters
+struct StatementCacheStats
+{
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+
+	StatementCacheStats () :
+		hits (0),
+		misses (0),
+		evictions (0)
+	{}
+};
+
+/// Replace SQL literals with parameter markers.
+///
+/// Also collapses whitespace and strips comments, so the statements which differ
+/// in literals only get the same text.
+///
+/// Literals which can't be parameters or define the result are kept: ORDER BY and GROUP BY
+/// column indexes, type name arguments and the select list items.
+///
+/// \param sql The SQL text.
+/// \param [out] normalized The normalized SQL text.
+/// \param [out] literals The literals in order of occurrence.
+/// \returns `false` if the statement can't be normalized because it already contains
+///          parameter markers.
+bool normalize_sql (const IDL::String& sql, IDL::String& normalized, Row& literals);
+
+/// Bounded LRU cache of the prepared statement pools.
+///
+/// The entry can be evicted only when all statements prepared for it are returned to the pool.
+class StatementCache
+{
+public:
+	/// Default limit of the prepared statement count
+	static const size_t DEFAULT_MAX_COUNT = 256;
+
+	/// Default limit of the SQL text bytes held by the prepared statements
+	static const size_t DEFAULT_MAX_BYTES = 1024 * 1024;
+
+	struct Entry : StatementPool <PreparedStatement>
+	{
+		const IDL::String* sql;
+		size_t created;
+		Entry* prev;
+		Entry* next;
+
+		// The normalized SQL failed to prepare, the original SQL is used instead.
+		bool normalize_failed;
+
+		Entry () :
+			sql (nullptr),
+			created (0),
+			prev (nullptr),
+			next (nullptr),
+			normalize_failed (false)
+		{}
+
+		bool idle () const noexcept
+		{
+			return size () == created;
+		}
+	};
+
+	StatementCache () :
+		head_ (nullptr),
+		tail_ (nullptr),
+		count_ (0),
+		bytes_ (0)
+	{}
+
+	StatementCache (StatementCache&& src) noexcept :
+		map_ (std::move (src.map_)),
+		head_ (src.head_),
+		tail_ (src.tail_),
+		count_ (src.count_),
+		bytes_ (src.bytes_),
+		stats_ (src.stats_)
+	{
+		src.head_ = src.tail_ = nullptr;
+		src.count_ = src.bytes_ = 0;
+	}
+
+	StatementCache (const StatementCache&) = delete;
+	StatementCache& operator = (const StatementCache&) = delete;
+	StatementCache& operator = (StatementCache&&) = delete;
+
+	/// Find or create the entry and move it to the head of LRU list.
+	Entry& get (const IDL::String& sql);
+
+	/// Count the statement got from the pool.
+	void hit () noexcept
+	{
+		++stats_.hits;
+	}
+
+	/// Count the statement to be prepared for the entry and evict the least recently used entries
+	/// over the limits.
+	///
+	/// \returns Number of evicted entries.
+	size_t miss (Entry& entry, size_t max_count, size_t max_bytes);
+
+	/// Undo miss () if the statement preparation failed.
+	void cancel_miss (Entry& entry) noexcept
+	{
+		assert (entry.created);
+		--entry.created;
+		--count_;
+		bytes_ -= entry.sql->size ();
+	}
+
+	/// Uncount the statement which was dropped instead of returning to the pool.
+	void release_failed (const IDL::String& sql) noexcept
+	{
+		auto it = map_.find (sql);
+		assert (it != map_.end ());
+		cancel_miss (it->second);
+	}
+
+	void clear () noexcept;
+
+	size_t count () const noexcept
+	{
+		return count_;
+	}
+
+	size_t bytes () const noexcept
+	{
+		return bytes_;
+	}
+
+	const StatementCacheStats& stats () const noexcept
+	{
+		return stats_;
+	}
+
+private:
+	void unlink (Entry& entry) noexcept;
+	void push_front (Entry& entry) noexcept;
+
+private:
+	Nirvana::Core::MapUnorderedStable <IDL::String, Entry> map_;
+	Entry* head_;
+	Entry* tail_;
+	size_t count_;
+	size_t bytes_;
+	StatementCacheStats stats_;
+};
+
+inline bool PoolablePreparedStatement::release_to_pool () noexcept
+{
+	if (Base::release_to_pool ())
+		return true;
+
+	// Otherwise the entry would never become idle and could not be evicted
+	cache_.release_failed (sql_);
+	return false;
+}
+
+}
+
+#endif